@@ -513,6 +513,18 @@ void RS232_flushRXTX(int comport_number)
 }
 
 
+/* return the file descriptor of a port opened with RS232_OpenComport or -1 if there is no such port */
+int RS232_GetFd(int comport_number)
+{
+  if((comport_number>=RS232_PORTNR)||(comport_number<0))
+  {
+    return -1;
+  }
+
+  return Cport[comport_number];
+}
+
+
 #else  /* windows */
 
 #define RS232_PORTNR  (48)
@@ -916,6 +928,25 @@ int RS232_GetPortnr(const char *devname)
 }
 
 
+/* return the number of ports, i.e. the number of valid comport_number values */
+int RS232_GetPortCount(void)
+{
+  return RS232_PORTNR;
+}
+
+
+/* return the device name of a port or NULL if there is no such port */
+const char * RS232_GetPortName(int comport_number)
+{
+  if((comport_number>=RS232_PORTNR)||(comport_number<0))
+  {
+    return NULL;
+  }
+
+  return comports[comport_number];
+}
+
+
 
 
 
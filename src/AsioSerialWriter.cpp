@@ -0,0 +1,155 @@
+/*
+ * AsioSerialWriter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "AsioSerialWriter.h"
+
+#include "SerialWriter.h"
+
+#include <algorithm>
+
+AsioSerialWriter::AsioSerialWriter(asio::io_context &io_context, const std::string &device, unsigned int baud_rate, const std::string &mode, std::size_t queue_size) :
+				_io_context(io_context),
+				_port(io_context),
+				_close_timer(io_context),
+				_queue_size(std::max<std::size_t>(queue_size, 1)) {
+	SerialMode framing;
+	try {
+		framing = SerialMode::parse(mode);
+	}
+	catch(std::invalid_argument &e) {
+		throw bad_serial_port(e.what());
+	}
+
+	asio::serial_port_base::parity::type parity = asio::serial_port_base::parity::none;
+	if(framing.parity == 'E') {
+		parity = asio::serial_port_base::parity::even;
+	}
+	else if(framing.parity == 'O') {
+		parity = asio::serial_port_base::parity::odd;
+	}
+	auto stop_bits = (framing.stop_bits == 2) ? asio::serial_port_base::stop_bits::two : asio::serial_port_base::stop_bits::one;
+
+	asio::error_code ec;
+	_port.open(device, ec);
+	if(!ec) {
+		_port.set_option(asio::serial_port_base::baud_rate(baud_rate), ec);
+	}
+	if(!ec) {
+		_port.set_option(asio::serial_port_base::character_size(framing.data_bits), ec);
+	}
+	if(!ec) {
+		_port.set_option(asio::serial_port_base::parity(parity), ec);
+	}
+	if(!ec) {
+		_port.set_option(asio::serial_port_base::stop_bits(stop_bits), ec);
+	}
+	if(!ec) {
+		_port.set_option(asio::serial_port_base::flow_control(asio::serial_port_base::flow_control::none), ec);
+	}
+	if(ec) {
+		throw bad_serial_port("cannot open '" + device + "': " + ec.message());
+	}
+}
+
+bool AsioSerialWriter::write(std::string_view frame) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if(_closing || _pending_frames >= _queue_size) {
+		_dropped++;
+		return false;
+	}
+
+	_pending.append(frame.data(), frame.size());
+	_pending_frames++;
+	_queued++;
+	if(!_writing) {
+		_writing = true;
+		asio::post(_io_context, [this]() {
+			_write_next();
+		});
+	}
+	return true;
+}
+
+void AsioSerialWriter::_write_next() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_pending.empty()) {
+			_writing = false;
+			if(_closing) {
+				// everything has been written, there is no need to wait for the deadline
+				_close_timer.cancel();
+				asio::error_code ec;
+				_port.close(ec);
+			}
+			return;
+		}
+		_sending.swap(_pending);
+		_pending.clear();
+		_pending_frames = 0;
+		_n_writes++;
+	}
+
+	asio::async_write(_port, asio::buffer(_sending), [this](const asio::error_code &ec, std::size_t n) {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_bytes_sent += n;
+			if(ec) {
+				// the port has failed or has been closed, the frames that are still queued cannot be written
+				_writing = false;
+				_pending.clear();
+				_pending_frames = 0;
+				_close_timer.cancel();
+				return;
+			}
+		}
+		_write_next();
+	});
+}
+
+void AsioSerialWriter::close(std::chrono::milliseconds max_drain) {
+	asio::post(_io_context, [this, max_drain]() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_closing) {
+			return;
+		}
+		_closing = true;
+		if(!_writing) {
+			asio::error_code ec;
+			_port.close(ec);
+			return;
+		}
+
+		// a port held back by flow control would never complete the write in progress
+		_close_timer.expires_after(max_drain);
+		_close_timer.async_wait([this](const asio::error_code &ec) {
+			if(!ec) {
+				asio::error_code close_ec;
+				_port.close(close_ec);
+			}
+		});
+	});
+}
+
+uint64_t AsioSerialWriter::queued() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _queued;
+}
+
+uint64_t AsioSerialWriter::dropped() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _dropped;
+}
+
+uint64_t AsioSerialWriter::bytes_sent() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _bytes_sent;
+}
+
+uint64_t AsioSerialWriter::n_writes() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _n_writes;
+}
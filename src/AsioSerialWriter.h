@@ -0,0 +1,100 @@
+/*
+ * AsioSerialWriter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef ASIOSERIALWRITER_H_
+#define ASIOSERIALWRITER_H_
+
+#include <asio.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+class bad_serial_port: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * Writes frames to a serial port with asynchronous writes issued on an event loop. Frames can be added from any
+ * thread and are never waited for: they are appended to a bounded queue, and all the frames that have been queued
+ * while a write was in progress are sent together by the next one. Frames that do not fit in the queue are dropped
+ * whole.
+ */
+class AsioSerialWriter {
+public:
+	/**
+	 * Open and configure the serial port. Throws bad_serial_port on error.
+	 *
+	 * @param io_context the event loop the writes are issued on
+	 * @param device the path of the serial port (e.g. /dev/ttyUSB0)
+	 * @param baud_rate
+	 * @param mode data bits, parity and stop bits (e.g. 8N1)
+	 * @param queue_size the maximum number of frames waiting to be written
+	 */
+	AsioSerialWriter(asio::io_context &io_context, const std::string &device, unsigned int baud_rate, const std::string &mode, std::size_t queue_size);
+	AsioSerialWriter(const AsioSerialWriter &) = delete;
+	virtual ~AsioSerialWriter() = default;
+
+	/**
+	 * Queue a frame. Can be called from any thread.
+	 *
+	 * @return false if the queue is full and the frame has been dropped
+	 */
+	bool write(std::string_view frame);
+
+	/**
+	 * Stop accepting frames and close the port once the queued frames have been written or after the given time,
+	 * whichever comes first. Can be called from any thread.
+	 */
+	void close(std::chrono::milliseconds max_drain=std::chrono::milliseconds(1000));
+
+	/**
+	 * Return the number of frames accepted by the queue.
+	 */
+	uint64_t queued() const;
+
+	/**
+	 * Return the number of frames that did not fit in the queue.
+	 */
+	uint64_t dropped() const;
+
+	/**
+	 * Return the number of bytes written to the port.
+	 */
+	uint64_t bytes_sent() const;
+
+	/**
+	 * Return the number of asynchronous writes issued so far.
+	 */
+	uint64_t n_writes() const;
+
+private:
+	void _write_next();
+
+	asio::io_context &_io_context;
+	asio::serial_port _port;
+	asio::steady_timer _close_timer;
+	std::size_t _queue_size;
+
+	// protects everything below
+	mutable std::mutex _mutex;
+	// the frames waiting to be written, swapped with _sending when a write starts
+	std::string _pending;
+	std::size_t _pending_frames = 0;
+	std::string _sending;
+	bool _writing = false;
+	bool _closing = false;
+	uint64_t _queued = 0;
+	uint64_t _dropped = 0;
+	uint64_t _bytes_sent = 0;
+	uint64_t _n_writes = 0;
+};
+
+#endif /* ASIOSERIALWRITER_H_ */
@@ -0,0 +1,164 @@
+/*
+ * BinaryFormat.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "BinaryFormat.h"
+
+#include "LittleEndian.h"
+
+#include <cstring>
+
+namespace {
+
+using le::put;
+
+template<typename T>
+T get(std::istream &input) {
+	char buffer[sizeof(T)];
+	if(!input.read(buffer, sizeof(T))) {
+		throw bad_binary_log("unexpected end of file");
+	}
+	return le::get<T>(buffer);
+}
+
+double get_double(std::istream &input) {
+	char buffer[sizeof(double)];
+	if(!input.read(buffer, sizeof(double))) {
+		throw bad_binary_log("unexpected end of file");
+	}
+	return le::get_double(buffer);
+}
+
+int64_t epoch_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
+
+BinaryWriter::BinaryWriter(OutputWriter &output, std::size_t n_devices) :
+				_output(output),
+				_described(n_devices, -1) {
+	std::string header(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	put(header, BINARY_VERSION);
+	put(header, epoch_ns());
+	_output.append(header);
+}
+
+void BinaryWriter::write(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty, std::chrono::system_clock::time_point time) {
+	// each thread encodes its records in its own buffer, which is reused across samples
+	thread_local std::string block;
+	block.clear();
+
+	bool has_uncertainty = uncertainty >= 0;
+	// the description changes if the number of values changes or if the uncertainty appears
+	int64_t description = 2 * static_cast<int64_t>(values.size()) + has_uncertainty;
+	if(_described[slot] != description) {
+		block += BINARY_DEVICE_BLOCK;
+		put(block, static_cast<uint16_t>(slot));
+		put(block, static_cast<int32_t>(device_id));
+		put(block, static_cast<uint16_t>(tag.size()));
+		block += tag;
+		put(block, static_cast<uint8_t>(has_uncertainty));
+		put(block, static_cast<uint16_t>(values.size()));
+		for(std::size_t i = 0; i < values.size(); i++) {
+			put(block, static_cast<uint8_t>(schema[i].type));
+			put(block, static_cast<uint8_t>(schema[i].decimals));
+		}
+		_described[slot] = description;
+	}
+
+	block += BINARY_RECORD_BLOCK;
+	put(block, static_cast<uint16_t>(slot));
+	put(block, delta_time);
+	put(block, std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+	if(has_uncertainty) {
+		put(block, uncertainty);
+	}
+	for(std::size_t i = 0; i < values.size(); i++) {
+		if(schema[i].type == ChannelType::DOUBLE) {
+			le::put_double(block, values[i].d);
+		}
+		else {
+			put(block, values[i].i);
+		}
+	}
+
+	_output.append(block);
+}
+
+BinaryReader::BinaryReader(std::istream &input) :
+				_input(input) {
+	char magic[sizeof(BINARY_MAGIC)];
+	if(!_input.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+		throw bad_binary_log("not a PADL binary log");
+	}
+
+	uint16_t version = get<uint16_t>(_input);
+	if(version != BINARY_VERSION) {
+		throw bad_binary_log("unsupported binary log version " + std::to_string(version));
+	}
+	_start_time = get<int64_t>(_input);
+}
+
+bool BinaryReader::next(BinaryRecord &record) {
+	while(true) {
+		char kind;
+		if(!_input.get(kind)) {
+			return false;
+		}
+
+		uint16_t slot = get<uint16_t>(_input);
+		if(kind == BINARY_DEVICE_BLOCK) {
+			if(slot >= _devices.size()) {
+				_devices.resize(slot + 1);
+				_described.resize(slot + 1, false);
+			}
+			_described[slot] = true;
+			BinaryDevice &device = _devices[slot];
+			device.device_id = get<int32_t>(_input);
+			device.tag.resize(get<uint16_t>(_input));
+			if(!_input.read(&device.tag[0], device.tag.size())) {
+				throw bad_binary_log("unexpected end of file");
+			}
+			device.has_uncertainty = get<uint8_t>(_input) != 0;
+			device.specs.resize(get<uint16_t>(_input));
+			for(auto &spec : device.specs) {
+				uint8_t type = get<uint8_t>(_input);
+				if(type > static_cast<uint8_t>(ChannelType::FIXED)) {
+					throw bad_binary_log("unknown channel type " + std::to_string(type));
+				}
+				spec.type = static_cast<ChannelType>(type);
+				spec.decimals = get<uint8_t>(_input);
+				if(spec.decimals > MAX_DECIMALS) {
+					throw bad_binary_log("invalid number of decimal digits " + std::to_string(spec.decimals));
+				}
+			}
+		}
+		else if(kind == BINARY_RECORD_BLOCK) {
+			if(slot >= _devices.size() || !_described[slot]) {
+				throw bad_binary_log("record of device " + std::to_string(slot) + ", which has not been described");
+			}
+			const BinaryDevice &device = _devices[slot];
+			record.device = &device;
+			record.delta_time = get<uint64_t>(_input);
+			record.epoch_ns = get<int64_t>(_input);
+			record.uncertainty = (device.has_uncertainty) ? get<int64_t>(_input) : -1;
+			record.values.resize(device.specs.size());
+			for(std::size_t i = 0; i < device.specs.size(); i++) {
+				if(device.specs[i].type == ChannelType::DOUBLE) {
+					record.values[i].d = get_double(_input);
+				}
+				else {
+					record.values[i].i = get<int32_t>(_input);
+				}
+			}
+			return true;
+		}
+		else {
+			throw bad_binary_log("unknown block kind " + std::to_string(static_cast<int>(kind)));
+		}
+	}
+}
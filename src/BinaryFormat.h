@@ -0,0 +1,143 @@
+/*
+ * BinaryFormat.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef BINARYFORMAT_H_
+#define BINARYFORMAT_H_
+
+#include "channels.h"
+#include "OutputWriter.h"
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * The binary log is made of a file header followed by a sequence of blocks. All the numbers are little-endian.
+ *
+ * File header:
+ *   char[8]  magic, "PADLBIN" followed by a null character
+ *   uint16   version
+ *   int64    start time, in nanoseconds since the Unix epoch
+ *
+ * Each block starts with a one-byte kind. A device block ('D') describes the records of a device and is written
+ * before its first record, and again whenever the number of readings of the device changes:
+ *   uint16   slot, the number used by the records of the device
+ *   int32    device id, or -1 if the device is the only one and its tag is not printed
+ *   uint16   length of the tag, followed by the tag
+ *   uint8    1 if the records carry the timing uncertainty, 0 otherwise
+ *   uint16   number of channels, followed by the type (uint8, see ChannelType) and the number of decimal
+ *            digits (uint8) of each channel
+ *
+ * A record block ('R') has a fixed size that depends on the description of its device:
+ *   uint16   slot
+ *   uint64   delta_time, in microseconds
+ *   int64    time at which the sample was printed, in nanoseconds since the Unix epoch
+ *   int64    uncertainty, in microseconds (only if the device carries it)
+ *   the readings: int32 for int and fixed-point channels, IEEE 754 double for floating-point channels
+ */
+
+constexpr char BINARY_MAGIC[8] = {'P', 'A', 'D', 'L', 'B', 'I', 'N', '\0'};
+constexpr uint16_t BINARY_VERSION = 1;
+constexpr char BINARY_DEVICE_BLOCK = 'D';
+constexpr char BINARY_RECORD_BLOCK = 'R';
+
+class bad_binary_log: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * The description of the records of a device.
+ */
+struct BinaryDevice {
+	int32_t device_id = -1;
+	std::string tag;
+	bool has_uncertainty = false;
+	std::vector<ChannelSpec> specs;
+};
+
+/**
+ * A sample read back from a binary log.
+ */
+struct BinaryRecord {
+	const BinaryDevice *device = nullptr;
+	uint64_t delta_time = 0;
+	int64_t epoch_ns = 0;
+	int64_t uncertainty = -1;
+	std::vector<ChannelValue> values;
+};
+
+/**
+ * Encodes samples as binary records and hands them to an OutputWriter.
+ *
+ * Records of different devices can be written concurrently, provided that the records of each device are always
+ * written by the same thread.
+ */
+class BinaryWriter {
+public:
+	/**
+	 * Write the file header.
+	 *
+	 * @param output
+	 * @param n_devices the number of devices whose samples will be written
+	 */
+	BinaryWriter(OutputWriter &output, std::size_t n_devices);
+	BinaryWriter(const BinaryWriter &) = delete;
+
+	/**
+	 * Write a sample of a device.
+	 *
+	 * @param slot the index of the device, smaller than n_devices
+	 * @param device_id the id that will be printed when converting the log back to text, or -1
+	 * @param tag
+	 * @param values
+	 * @param schema the types of the values
+	 * @param delta_time
+	 * @param uncertainty the timing uncertainty, or -1 if it is not available
+	 * @param time the time at which the sample was received
+	 */
+	void write(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty, std::chrono::system_clock::time_point time);
+
+private:
+	OutputWriter &_output;
+	// the description (twice the number of channels, plus one if there is the uncertainty) last written for each
+	// device, or -1 if the device has not been described yet
+	std::vector<int64_t> _described;
+};
+
+/**
+ * Decodes a binary log.
+ */
+class BinaryReader {
+public:
+	/**
+	 * Read the file header. Throws bad_binary_log if the stream does not contain a binary log.
+	 */
+	BinaryReader(std::istream &input);
+
+	/**
+	 * Read the next record. Throws bad_binary_log if the log is corrupted. The device the record points to is valid
+	 * until the next call.
+	 *
+	 * @return false if there are no more records
+	 */
+	bool next(BinaryRecord &record);
+
+	int64_t start_time() const {
+		return _start_time;
+	}
+
+private:
+	std::istream &_input;
+	int64_t _start_time = 0;
+	std::vector<BinaryDevice> _devices;
+	std::vector<bool> _described;
+};
+
+#endif /* BINARYFORMAT_H_ */
@@ -0,0 +1,228 @@
+/*
+ * ColumnCodec.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "ColumnCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint64_t zigzag(int64_t value) {
+	return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+	return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+void put_varint(std::string &out, uint64_t value) {
+	while(value >= 0x80) {
+		out += static_cast<char>((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+uint64_t get_varint(const char *&ptr, const char *end) {
+	uint64_t value = 0;
+	for(int shift = 0; shift < 64; shift += 7) {
+		if(ptr == end) {
+			throw bad_column("truncated varint");
+		}
+		uint8_t byte = *ptr++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if((byte & 0x80) == 0) {
+			return value;
+		}
+	}
+	throw bad_column("invalid varint");
+}
+
+std::size_t varint_size(uint64_t value) {
+	std::size_t size = 1;
+	while(value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+int bit_width(uint64_t value) {
+	return (value == 0) ? 0 : 64 - __builtin_clzll(value);
+}
+
+/**
+ * Appends groups of bits to a string, least significant bit first.
+ */
+struct BitWriter {
+	std::string &out;
+	uint64_t accumulator = 0;
+	// the number of bits in the accumulator, always smaller than 8 between two calls
+	int n_bits = 0;
+
+	void put(uint64_t value, int width) {
+		while(width > 0) {
+			int take = std::min(width, 64 - n_bits);
+			uint64_t part = (take == 64) ? value : value & ((1ull << take) - 1);
+			accumulator |= part << n_bits;
+			n_bits += take;
+			value = (take == 64) ? 0 : value >> take;
+			width -= take;
+			while(n_bits >= 8) {
+				out += static_cast<char>(accumulator & 0xff);
+				accumulator >>= 8;
+				n_bits -= 8;
+			}
+		}
+	}
+
+	void finish() {
+		if(n_bits > 0) {
+			out += static_cast<char>(accumulator & 0xff);
+			accumulator = 0;
+			n_bits = 0;
+		}
+	}
+};
+
+/**
+ * Turn the values into zigzag-encoded differences. The first difference is taken with respect to zero. Differences
+ * are computed with unsigned arithmetic, so that they wrap around instead of overflowing.
+ */
+void to_deltas(const std::vector<int64_t> &values, std::vector<uint64_t> &deltas) {
+	deltas.resize(values.size());
+	uint64_t previous = 0;
+	for(std::size_t i = 0; i < values.size(); i++) {
+		uint64_t current = static_cast<uint64_t>(values[i]);
+		deltas[i] = zigzag(static_cast<int64_t>(current - previous));
+		previous = current;
+	}
+}
+
+}
+
+ColumnEncoding encode_int_column(const std::vector<int64_t> &values, std::string &out) {
+	thread_local std::vector<uint64_t> deltas;
+	to_deltas(values, deltas);
+
+	// the size of the two encodings can be computed without encoding the column
+	std::size_t varint_bytes = 0;
+	for(auto delta : deltas) {
+		varint_bytes += varint_size(delta);
+	}
+
+	uint64_t min = 0, max = 0;
+	if(deltas.size() > 1) {
+		auto minmax = std::minmax_element(deltas.begin() + 1, deltas.end());
+		min = *minmax.first;
+		max = *minmax.second;
+	}
+	int width = bit_width(max - min);
+	std::size_t packed_bytes = 0;
+	if(!deltas.empty()) {
+		packed_bytes = varint_size(deltas[0]) + varint_size(min) + 1 + ((deltas.size() - 1) * width + 7) / 8;
+	}
+
+	if(varint_bytes <= packed_bytes) {
+		for(auto delta : deltas) {
+			put_varint(out, delta);
+		}
+		return ColumnEncoding::DELTA_VARINT;
+	}
+
+	put_varint(out, deltas[0]);
+	put_varint(out, min);
+	out += static_cast<char>(width);
+	// the values are packed LSB-first into a little-endian bit stream
+	BitWriter writer{out};
+	for(std::size_t i = 1; i < deltas.size(); i++) {
+		writer.put(deltas[i] - min, width);
+	}
+	writer.finish();
+
+	return ColumnEncoding::DELTA_BITPACK;
+}
+
+ColumnEncoding encode_double_column(const std::vector<double> &values, std::string &out) {
+	uint64_t previous = 0;
+	for(auto value : values) {
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		put_varint(out, bits ^ previous);
+		previous = bits;
+	}
+
+	return ColumnEncoding::XOR_VARINT;
+}
+
+void decode_int_column(std::string_view data, ColumnEncoding encoding, std::size_t n_values, std::vector<int64_t> &values) {
+	values.resize(n_values);
+	const char *ptr = data.data();
+	const char *end = ptr + data.size();
+	if(n_values == 0) {
+		return;
+	}
+
+	uint64_t current = 0;
+	if(encoding == ColumnEncoding::DELTA_VARINT) {
+		for(std::size_t i = 0; i < n_values; i++) {
+			current += static_cast<uint64_t>(unzigzag(get_varint(ptr, end)));
+			values[i] = static_cast<int64_t>(current);
+		}
+	}
+	else if(encoding == ColumnEncoding::DELTA_BITPACK) {
+		current = static_cast<uint64_t>(unzigzag(get_varint(ptr, end)));
+		values[0] = static_cast<int64_t>(current);
+		uint64_t min = get_varint(ptr, end);
+		if(ptr == end) {
+			throw bad_column("truncated bit-packed column");
+		}
+		int width = static_cast<uint8_t>(*ptr++);
+		if(width > 64) {
+			throw bad_column("invalid bit width");
+		}
+		if(static_cast<std::size_t>(end - ptr) < ((n_values - 1) * width + 7) / 8) {
+			throw bad_column("truncated bit-packed column");
+		}
+
+		uint64_t mask = (width == 64) ? ~0ull : (1ull << width) - 1;
+		std::size_t bit = 0;
+		for(std::size_t i = 1; i < n_values; i++) {
+			uint64_t value = 0;
+			for(int done = 0; done < width;) {
+				std::size_t byte = (bit + done) / 8;
+				int offset = (bit + done) % 8;
+				int take = std::min(8 - offset, width - done);
+				uint64_t chunk = (static_cast<uint8_t>(ptr[byte]) >> offset) & ((1u << take) - 1);
+				value |= chunk << done;
+				done += take;
+			}
+			bit += width;
+			current += static_cast<uint64_t>(unzigzag((value & mask) + min));
+			values[i] = static_cast<int64_t>(current);
+		}
+	}
+	else {
+		throw bad_column("unknown integer column encoding " + std::to_string(static_cast<int>(encoding)));
+	}
+}
+
+void decode_double_column(std::string_view data, ColumnEncoding encoding, std::size_t n_values, std::vector<double> &values) {
+	if(encoding != ColumnEncoding::XOR_VARINT) {
+		throw bad_column("unknown floating-point column encoding " + std::to_string(static_cast<int>(encoding)));
+	}
+
+	values.resize(n_values);
+	const char *ptr = data.data();
+	const char *end = ptr + data.size();
+	uint64_t previous = 0;
+	for(std::size_t i = 0; i < n_values; i++) {
+		previous ^= get_varint(ptr, end);
+		std::memcpy(&values[i], &previous, sizeof(previous));
+	}
+}
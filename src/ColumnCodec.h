@@ -0,0 +1,57 @@
+/*
+ * ColumnCodec.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef COLUMNCODEC_H_
+#define COLUMNCODEC_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * The encodings of a column of numbers.
+ */
+enum class ColumnEncoding : uint8_t {
+	/// the differences between consecutive values, zigzag-encoded and stored as LEB128 varints
+	DELTA_VARINT = 1,
+	/// the zigzag-encoded differences between consecutive values, minus their minimum, packed with the smallest
+	/// number of bits that fits them all
+	DELTA_BITPACK = 2,
+	/// the bits of each floating-point value XOR-ed with those of the previous one, stored as varints
+	XOR_VARINT = 3
+};
+
+class bad_column: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * Encode a column of integers with the encoding, among DELTA_VARINT and DELTA_BITPACK, that gives the smallest output,
+ * and append it to out.
+ *
+ * @return the encoding that has been used
+ */
+ColumnEncoding encode_int_column(const std::vector<int64_t> &values, std::string &out);
+
+/**
+ * Encode a column of floating-point numbers with XOR_VARINT and append it to out.
+ */
+ColumnEncoding encode_double_column(const std::vector<double> &values, std::string &out);
+
+/**
+ * Decode n_values integers. Throws bad_column if the data is corrupted.
+ */
+void decode_int_column(std::string_view data, ColumnEncoding encoding, std::size_t n_values, std::vector<int64_t> &values);
+
+/**
+ * Decode n_values floating-point numbers. Throws bad_column if the data is corrupted.
+ */
+void decode_double_column(std::string_view data, ColumnEncoding encoding, std::size_t n_values, std::vector<double> &values);
+
+#endif /* COLUMNCODEC_H_ */
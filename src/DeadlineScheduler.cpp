@@ -0,0 +1,102 @@
+/*
+ * DeadlineScheduler.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "DeadlineScheduler.h"
+
+void JitterHistogram::add(std::chrono::microseconds delay) {
+	auto us = std::max<int64_t>(delay.count(), 0);
+
+	int bin = 0;
+	while(us > 0 && bin < N_BINS - 1) {
+		us >>= 1;
+		bin++;
+	}
+	_bins[bin]++;
+
+	_count++;
+	_total += delay;
+	_max = std::max(_max, delay);
+}
+
+void JitterHistogram::print(std::ostream &out) const {
+	for(int i = 0; i < N_BINS; i++) {
+		if(_bins[i] == 0) {
+			continue;
+		}
+
+		if(i == 0) {
+			out << "\t< 1 us: ";
+		}
+		else if(i == N_BINS - 1) {
+			out << "\t>= " << (1ull << (i - 1)) << " us: ";
+		}
+		else {
+			out << "\t[" << (1ull << (i - 1)) << ", " << (1ull << i) << ") us: ";
+		}
+		out << _bins[i] << std::endl;
+	}
+}
+
+DeadlineScheduler::DeadlineScheduler(asio::io_context &io_context, std::chrono::microseconds period) :
+				_timer(io_context),
+				_period(period) {
+
+}
+
+void DeadlineScheduler::start(Callback callback) {
+	_callback = callback;
+	_start = std::chrono::steady_clock::now();
+	_deadline_idx = 0;
+	_schedule();
+}
+
+void DeadlineScheduler::set_period(std::chrono::microseconds period) {
+	// move the origin to the next deadline
+	_start += _deadline_idx * _period;
+	_deadline_idx = 0;
+	_period = period;
+}
+
+void DeadlineScheduler::stop() {
+	_timer.cancel();
+}
+
+void DeadlineScheduler::_schedule() {
+	_timer.expires_at(_start + _deadline_idx * _period);
+	_timer.async_wait([this](const asio::error_code &ec) {
+		if(!ec) {
+			_on_deadline();
+		}
+	});
+}
+
+void DeadlineScheduler::_on_deadline() {
+	auto now = std::chrono::steady_clock::now();
+	auto ideal = _start + _deadline_idx * _period;
+	auto delay = std::chrono::duration_cast<std::chrono::microseconds>(now - ideal);
+	_jitter.add(delay);
+
+	if(_callback()) {
+		_served++;
+	}
+	else {
+		_missed++;
+	}
+
+	// deadlines that have already passed are skipped (and counted) instead of being served in a burst
+	uint64_t late = (delay.count() > 0) ? delay / _period : 0;
+	_missed += late;
+	_deadline_idx += late + 1;
+
+	_schedule();
+}
+
+void DeadlineScheduler::print_stats(std::ostream &out) const {
+	out << "period: " << _period.count() << " us, deadlines served: " << _served << ", missed: " << _missed;
+	out << ", jitter mean: " << _jitter.mean().count() << " us, max: " << _jitter.max().count() << " us" << std::endl;
+	_jitter.print(out);
+}
@@ -0,0 +1,108 @@
+/*
+ * DeadlineScheduler.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef DEADLINESCHEDULER_H_
+#define DEADLINESCHEDULER_H_
+
+#include <asio.hpp>
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <ostream>
+
+/**
+ * A histogram of the delays between the ideal and the actual firing times of a timer. Bins are logarithmic: the
+ * first one collects delays smaller than 1 us, the i-th one delays in [2^(i-1), 2^i) us and the last one everything else.
+ */
+class JitterHistogram {
+public:
+	static constexpr int N_BINS = 24;
+
+	void add(std::chrono::microseconds delay);
+	void print(std::ostream &out) const;
+
+	uint64_t count() const {
+		return _count;
+	}
+
+	std::chrono::microseconds max() const {
+		return _max;
+	}
+
+	std::chrono::microseconds mean() const {
+		return (_count > 0) ? _total / static_cast<int64_t>(_count) : std::chrono::microseconds(0);
+	}
+
+private:
+	std::array<uint64_t, N_BINS> _bins{};
+	uint64_t _count = 0;
+	std::chrono::microseconds _total{0};
+	std::chrono::microseconds _max{0};
+};
+
+/**
+ * A timer that fires at exact multiples of a period, measured from the moment start() is called. Since deadlines
+ * are absolute, the time spent in the callback does not make the period drift. Deadlines that are missed, either
+ * because the timer fired more than one period late or because the callback could not serve them, are counted
+ * rather than being silently postponed.
+ */
+class DeadlineScheduler {
+public:
+	/**
+	 * The callback should return false if it could not serve the deadline (e.g. because the device is still busy
+	 * answering a previous request), in which case the deadline is counted as missed.
+	 */
+	using Callback = std::function<bool()>;
+
+	DeadlineScheduler(asio::io_context &io_context, std::chrono::microseconds period);
+
+	void start(Callback callback);
+	void stop();
+
+	std::chrono::microseconds period() const {
+		return _period;
+	}
+
+	/**
+	 * Change the period. The deadline that is currently scheduled is kept, and the following ones are spaced by
+	 * the new period.
+	 */
+	void set_period(std::chrono::microseconds period);
+
+	/// the number of deadlines served
+	uint64_t served() const {
+		return _served;
+	}
+
+	/// the number of deadlines missed
+	uint64_t missed() const {
+		return _missed;
+	}
+
+	const JitterHistogram &jitter() const {
+		return _jitter;
+	}
+
+	void print_stats(std::ostream &out) const;
+
+private:
+	void _schedule();
+	void _on_deadline();
+
+	asio::steady_timer _timer;
+	std::chrono::microseconds _period;
+	Callback _callback;
+	// the deadlines are _start + i * _period
+	std::chrono::steady_clock::time_point _start;
+	uint64_t _deadline_idx = 0;
+	uint64_t _served = 0;
+	uint64_t _missed = 0;
+	JitterHistogram _jitter;
+};
+
+#endif /* DEADLINESCHEDULER_H_ */
@@ -0,0 +1,144 @@
+/*
+ * DeviceConfig.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "DeviceConfig.h"
+
+#include "strings.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace {
+
+unsigned short parse_port(const std::string &source) {
+	int port;
+	try {
+		port = utils::lexical_cast<int>(source);
+	}
+	catch(utils::bad_lexical_cast &) {
+		throw bad_device_config("invalid port '" + source + "'");
+	}
+
+	if(port < 0 || port > 65535) {
+		throw bad_device_config("invalid port '" + source + "'");
+	}
+
+	return port;
+}
+
+std::string default_tag(const std::string &ip, unsigned short port) {
+	// IPv6 addresses are bracketed, so that the port can be told apart
+	if(ip.find(':') != std::string::npos) {
+		return "[" + ip + "]:" + std::to_string(port);
+	}
+	return ip + ":" + std::to_string(port);
+}
+
+}
+
+DeviceConfig parse_device(const std::string &source, std::chrono::milliseconds interval) {
+	std::string tag;
+	std::string endpoint = source;
+
+	auto eq = source.find('=');
+	if(eq != std::string::npos) {
+		tag = utils::trim_copy(source.substr(0, eq));
+		endpoint = utils::trim_copy(source.substr(eq + 1));
+	}
+
+	std::string ip;
+	std::string port;
+	if(endpoint.size() > 0 && endpoint[0] == '[') {
+		auto bracket = endpoint.find(']');
+		if(bracket == std::string::npos || bracket + 1 >= endpoint.size() || endpoint[bracket + 1] != ':') {
+			throw bad_device_config("device '" + source + "' should be given as [tag=][ipv6]:port");
+		}
+		ip = endpoint.substr(1, bracket - 1);
+		port = endpoint.substr(bracket + 2);
+	}
+	else {
+		auto colon = endpoint.find(':');
+		if(colon == std::string::npos) {
+			throw bad_device_config("device '" + source + "' should be given as [tag=]ip:port");
+		}
+		if(endpoint.find(':', colon + 1) != std::string::npos) {
+			throw bad_device_config("device '" + source + "' should be given as [tag=][ipv6]:port, with the IPv6 address enclosed in brackets");
+		}
+		ip = endpoint.substr(0, colon);
+		port = endpoint.substr(colon + 1);
+	}
+
+	DeviceConfig device = parse_device(ip, port, interval);
+	if(tag.size() > 0) {
+		device.tag = tag;
+	}
+
+	return device;
+}
+
+DeviceConfig parse_device(const std::string &ip, const std::string &port, std::chrono::milliseconds interval) {
+	if(interval.count() < 0) {
+		throw bad_device_config("the polling interval of device '" + ip + "' should be non-negative");
+	}
+
+	DeviceConfig device;
+	device.ip = utils::trim_copy(ip);
+	device.port = parse_port(port);
+	device.tag = default_tag(device.ip, device.port);
+	device.interval = interval;
+
+	return device;
+}
+
+bool is_device_endpoint(const std::string &source) {
+	// a bare IPv6 address contains more than one colon
+	return source.find('=') != std::string::npos || source.find('[') != std::string::npos || std::count(source.begin(), source.end(), ':') == 1;
+}
+
+std::vector<DeviceConfig> load_device_file(const std::string &filename, std::chrono::milliseconds default_interval) {
+	std::ifstream input(filename);
+	if(!input.good()) {
+		throw bad_device_config("cannot open the device file '" + filename + "'");
+	}
+
+	std::vector<DeviceConfig> devices;
+	std::string line;
+	int line_number = 0;
+	while(std::getline(input, line)) {
+		line_number++;
+		utils::trim(line);
+		if(line.size() == 0 || line[0] == '#') {
+			continue;
+		}
+
+		auto spl = utils::split(line, " \t");
+		if(spl.size() < 3 || spl.size() > 4) {
+			throw bad_device_config(filename + ", line " + std::to_string(line_number) + ": expected 'tag ip port [interval]'");
+		}
+
+		DeviceConfig device;
+		device.tag = spl[0];
+		device.ip = spl[1];
+		device.port = parse_port(spl[2]);
+		device.interval = default_interval;
+		if(spl.size() == 4) {
+			try {
+				device.interval = std::chrono::milliseconds(utils::lexical_cast<int>(spl[3]));
+			}
+			catch(utils::bad_lexical_cast &) {
+				throw bad_device_config(filename + ", line " + std::to_string(line_number) + ": invalid interval '" + spl[3] + "'");
+			}
+		}
+		if(device.interval.count() < 0) {
+			throw bad_device_config(filename + ", line " + std::to_string(line_number) + ": the interval should be non-negative");
+		}
+
+		devices.push_back(device);
+	}
+
+	return devices;
+}
@@ -0,0 +1,71 @@
+/*
+ * DeviceConfig.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef DEVICECONFIG_H_
+#define DEVICECONFIG_H_
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * The settings of a single DL device.
+ */
+struct DeviceConfig {
+	/// the name used to tag the output of the device
+	std::string tag;
+	std::string ip;
+	unsigned short port;
+	/// minimum time between two consecutive requests
+	std::chrono::milliseconds interval;
+};
+
+class bad_device_config: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * Parse a device given as "ip:port" or "tag=ip:port". IPv6 addresses should be enclosed in brackets, as in
+ * "[::1]:port". If no tag is given, "ip:port" is used.
+ *
+ * @param source
+ * @param interval the polling interval of the device
+ * @return the device configuration
+ */
+DeviceConfig parse_device(const std::string &source, std::chrono::milliseconds interval);
+
+/**
+ * Build the configuration of a device given as separate IP address (either IPv4 or IPv6) and port.
+ *
+ * @param ip
+ * @param port
+ * @param interval the polling interval of the device
+ * @return the device configuration
+ */
+DeviceConfig parse_device(const std::string &ip, const std::string &port, std::chrono::milliseconds interval);
+
+/**
+ * Return true if the given argument is a device in the "[tag=]ip:port" form rather than the IP address of an
+ * "ip port" pair.
+ */
+bool is_device_endpoint(const std::string &source);
+
+/**
+ * Load a list of devices from a file. Each non-empty line that does not start with a # has the format
+ *
+ * tag ip port [interval in milliseconds]
+ *
+ * where the interval cannot be negative.
+ *
+ * @param filename
+ * @param default_interval the interval used for the devices that do not specify it
+ * @return the list of devices
+ */
+std::vector<DeviceConfig> load_device_file(const std::string &filename, std::chrono::milliseconds default_interval);
+
+#endif /* DEVICECONFIG_H_ */
@@ -0,0 +1,387 @@
+/*
+ * Hub.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "Hub.h"
+
+#include "BinaryFormat.h"
+#include "LineBuffer.h"
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * A connection from which lines are read and broadcast. Publishers that send binary output, or lines that would not
+ * fit in the queue of a subscriber, are disconnected.
+ */
+class Hub::Publisher: public std::enable_shared_from_this<Publisher> {
+public:
+	Publisher(Hub &hub, asio::ip::tcp::socket socket, const std::string &name) :
+					_hub(hub),
+					_socket(std::move(socket)),
+					_name(name) {
+
+	}
+
+	void start() {
+		_read();
+	}
+
+	void close() {
+		asio::error_code ec;
+		_socket.close(ec);
+	}
+
+	const std::string &name() const {
+		return _name;
+	}
+
+private:
+	void _read() {
+		auto self = shared_from_this();
+		_socket.async_read_some(_buffer.prepare(), [this, self](const asio::error_code &ec, std::size_t n) {
+			if(ec) {
+				if(ec != asio::error::operation_aborted) {
+					if(_hub._log != nullptr) {
+						*_hub._log << "publisher " << _name << " disconnected" << std::endl;
+					}
+					_hub._publishers.erase(self);
+				}
+				return;
+			}
+
+			_buffer.commit(n);
+			if(!_checked) {
+				// binary output starts with a header that would be relayed as garbage
+				std::string_view head = _buffer.pending_data().substr(0, sizeof(BINARY_MAGIC));
+				if(std::string_view(BINARY_MAGIC, head.size()) == head) {
+					if(head.size() == sizeof(BINARY_MAGIC)) {
+						_disconnect("sends binary output, which cannot be relayed");
+						return;
+					}
+					// wait for the whole magic
+					_read();
+					return;
+				}
+				_checked = true;
+			}
+
+			std::string_view lines;
+			if(_buffer.next_lines(lines)) {
+				_hub._broadcast(lines);
+			}
+			// a line longer than the queue of a subscriber could not be relayed anyway
+			if(_buffer.pending() > _hub._queue_capacity) {
+				_disconnect("sent a line longer than " + std::to_string(_hub._queue_capacity) + " bytes");
+				return;
+			}
+			_read();
+		});
+	}
+
+	void _disconnect(const std::string &reason) {
+		if(_hub._log != nullptr) {
+			*_hub._log << "publisher " << _name << " " << reason << ", disconnecting it" << std::endl;
+		}
+		close();
+		_hub._publishers.erase(shared_from_this());
+	}
+
+	Hub &_hub;
+	asio::ip::tcp::socket _socket;
+	std::string _name;
+	LineBuffer _buffer;
+	// whether the first bytes have been checked for the header of binary output
+	bool _checked = false;
+};
+
+/**
+ * A connection the lines are sent to. The queue logic is independent of the kind of socket.
+ */
+class Hub::Subscriber: public std::enable_shared_from_this<Subscriber> {
+public:
+	Subscriber(Hub &hub, const std::string &name) :
+					_hub(hub),
+					_name(name) {
+
+	}
+
+	virtual ~Subscriber() = default;
+
+	virtual void start() = 0;
+	virtual void close() = 0;
+
+	/**
+	 * Queue a batch of lines, applying the overflow policy if the queue is full.
+	 */
+	void push(const std::shared_ptr<const std::string> &lines) {
+		if(_closed) {
+			return;
+		}
+
+		// a batch is always accepted by an empty queue, whatever its size
+		if(_queued + lines->size() > _hub._queue_capacity && !_queue.empty()) {
+			if(_hub._policy == OverflowPolicy::DISCONNECT) {
+				if(_hub._log != nullptr) {
+					*_hub._log << "subscriber " << _name << " is too slow, disconnecting it" << std::endl;
+				}
+				_shutdown();
+				return;
+			}
+
+			// the batch that is being written (the first one) cannot be dropped
+			std::size_t first_droppable = (_writing) ? 1 : 0;
+			while(_queued + lines->size() > _hub._queue_capacity && _queue.size() > first_droppable) {
+				auto &dropped = _queue[first_droppable];
+				_queued -= dropped->size();
+				_dropped += std::count(dropped->begin(), dropped->end(), '\n');
+				_queue.erase(_queue.begin() + first_droppable);
+			}
+		}
+
+		_queue.push_back(lines);
+		_queued += lines->size();
+		if(!_writing) {
+			_write_next();
+		}
+	}
+
+	const std::string &name() const {
+		return _name;
+	}
+
+protected:
+	/**
+	 * Send the given data, and call _on_sent once it has been sent.
+	 */
+	virtual void _send(const std::string &data) = 0;
+
+	void _on_sent(const asio::error_code &ec) {
+		_writing = false;
+		if(ec) {
+			if(ec != asio::error::operation_aborted) {
+				_shutdown();
+			}
+			return;
+		}
+
+		_sent += std::count(_queue.front()->begin(), _queue.front()->end(), '\n');
+		_queued -= _queue.front()->size();
+		_queue.pop_front();
+		if(!_queue.empty()) {
+			_write_next();
+		}
+	}
+
+	/**
+	 * Close the connection, report on the subscriber and remove it from the hub.
+	 */
+	void _shutdown() {
+		if(_closed) {
+			return;
+		}
+		_closed = true;
+		// the queue is left alone, since the batch that is being written must outlive the cancelled write
+		close();
+		if(_hub._log != nullptr) {
+			*_hub._log << "subscriber " << _name << " disconnected, lines sent: " << _sent << ", dropped: " << _dropped << std::endl;
+		}
+		_hub._remove(shared_from_this());
+	}
+
+	Hub &_hub;
+
+private:
+	void _write_next() {
+		_writing = true;
+		_send(*_queue.front());
+	}
+
+	std::string _name;
+	// the batches waiting to be sent, which are shared with the other subscribers
+	std::deque<std::shared_ptr<const std::string>> _queue;
+	std::size_t _queued = 0;
+	bool _writing = false;
+	bool _closed = false;
+	uint64_t _sent = 0;
+	uint64_t _dropped = 0;
+};
+
+template<typename Protocol>
+class Hub::SocketSubscriber: public Hub::Subscriber {
+public:
+	SocketSubscriber(Hub &hub, typename Protocol::socket socket, const std::string &name) :
+					Subscriber(hub, name),
+					_socket(std::move(socket)) {
+
+	}
+
+	void start() override {
+		_wait_for_eof();
+	}
+
+	void close() override {
+		asio::error_code ec;
+		_socket.close(ec);
+	}
+
+protected:
+	void _send(const std::string &data) override {
+		auto self = shared_from_this();
+		asio::async_write(_socket, asio::buffer(data), [this, self](const asio::error_code &ec, std::size_t) {
+			_on_sent(ec);
+		});
+	}
+
+private:
+	/**
+	 * Subscribers are not expected to send anything: reading is only a way of knowing when they go away.
+	 */
+	void _wait_for_eof() {
+		auto self = shared_from_this();
+		_socket.async_read_some(asio::buffer(_discard), [this, self](const asio::error_code &ec, std::size_t) {
+			if(ec) {
+				if(ec != asio::error::operation_aborted) {
+					_shutdown();
+				}
+				return;
+			}
+			_wait_for_eof();
+		});
+	}
+
+	typename Protocol::socket _socket;
+	char _discard[256];
+};
+
+Hub::Hub(asio::io_context &io_context, std::size_t queue_capacity, OverflowPolicy policy, std::ostream *log) :
+				_io_context(io_context),
+				_queue_capacity(queue_capacity),
+				_policy(policy),
+				_log(log) {
+
+}
+
+Hub::~Hub() {
+	close();
+}
+
+OverflowPolicy Hub::parse_policy(const std::string &name) {
+	if(name == "drop-oldest") {
+		return OverflowPolicy::DROP_OLDEST;
+	}
+	if(name == "disconnect") {
+		return OverflowPolicy::DISCONNECT;
+	}
+	throw std::invalid_argument("unknown overflow policy '" + name + "' (should be drop-oldest or disconnect)");
+}
+
+void Hub::listen_publishers(const asio::ip::address &address, unsigned short port) {
+	_publisher_acceptor.reset(new asio::ip::tcp::acceptor(_io_context, asio::ip::tcp::endpoint(address, port)));
+	_accept_publishers();
+}
+
+void Hub::listen_subscribers(const asio::ip::address &address, unsigned short port) {
+	_tcp_acceptor = std::make_shared<asio::ip::tcp::acceptor>(_io_context, asio::ip::tcp::endpoint(address, port));
+	_accept_subscribers(_tcp_acceptor);
+}
+
+void Hub::listen_subscribers(const std::string &path) {
+	// a socket left behind by a previous run would make the bind fail
+	struct stat info;
+	if(::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+		::unlink(path.c_str());
+	}
+
+	_unix_acceptor = std::make_shared<asio::local::stream_protocol::acceptor>(_io_context, asio::local::stream_protocol::endpoint(path));
+	_unix_path = path;
+	_accept_subscribers(_unix_acceptor);
+}
+
+void Hub::close() {
+	asio::error_code ec;
+	if(_publisher_acceptor) {
+		_publisher_acceptor->close(ec);
+	}
+	if(_tcp_acceptor) {
+		_tcp_acceptor->close(ec);
+	}
+	if(_unix_acceptor) {
+		_unix_acceptor->close(ec);
+		::unlink(_unix_path.c_str());
+		_unix_acceptor.reset();
+	}
+
+	for(auto &publisher : _publishers) {
+		publisher->close();
+	}
+	_publishers.clear();
+	for(auto &subscriber : _subscribers) {
+		subscriber->close();
+	}
+	_subscribers.clear();
+}
+
+void Hub::_accept_publishers() {
+	_publisher_acceptor->async_accept([this](const asio::error_code &ec, asio::ip::tcp::socket socket) {
+		if(ec) {
+			return;
+		}
+
+		asio::error_code endpoint_ec;
+		auto remote = socket.remote_endpoint(endpoint_ec);
+		std::string name = remote.address().to_string() + ":" + std::to_string(remote.port());
+		if(_log != nullptr) {
+			*_log << "publisher " << name << " connected" << std::endl;
+		}
+
+		auto publisher = std::make_shared<Publisher>(*this, std::move(socket), name);
+		_publishers.insert(publisher);
+		publisher->start();
+		_accept_publishers();
+	});
+}
+
+template<typename Acceptor>
+void Hub::_accept_subscribers(std::shared_ptr<Acceptor> acceptor) {
+	using Protocol = typename Acceptor::protocol_type;
+	acceptor->async_accept([this, acceptor](const asio::error_code &ec, typename Protocol::socket socket) {
+		if(ec) {
+			return;
+		}
+
+		std::string name = "#" + std::to_string(_next_id++);
+		if(_log != nullptr) {
+			*_log << "subscriber " << name << " connected" << std::endl;
+		}
+
+		std::shared_ptr<Subscriber> subscriber = std::make_shared<SocketSubscriber<Protocol>>(*this, std::move(socket), name);
+		_subscribers.insert(subscriber);
+		subscriber->start();
+		_accept_subscribers(acceptor);
+	});
+}
+
+void Hub::_broadcast(std::string_view lines) {
+	_lines += std::count(lines.begin(), lines.end(), '\n');
+	if(_subscribers.empty()) {
+		return;
+	}
+
+	auto batch = std::make_shared<const std::string>(lines);
+	// a subscriber may be removed while the batch is being pushed, hence the set is not iterated directly
+	std::vector<std::shared_ptr<Subscriber>> subscribers(_subscribers.begin(), _subscribers.end());
+	for(auto &subscriber : subscribers) {
+		subscriber->push(batch);
+	}
+}
+
+void Hub::_remove(const std::shared_ptr<Subscriber> &subscriber) {
+	_subscribers.erase(subscriber);
+}
@@ -0,0 +1,103 @@
+/*
+ * Hub.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef HUB_H_
+#define HUB_H_
+
+#include <asio.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+
+/**
+ * What the hub does when the queue of a subscriber is full.
+ */
+enum class OverflowPolicy {
+	/// discard the oldest lines that have not been sent yet
+	DROP_OLDEST,
+	/// close the connection to the subscriber
+	DISCONNECT
+};
+
+/**
+ * Relays the lines received from any number of publishers (e.g. "client --sink tcp:HOST:PORT") to any number of
+ * subscribers, connected over TCP or Unix sockets. The lines that arrive together are shared by all the subscribers,
+ * each of which has its own queue of bounded size, so that a slow subscriber never holds back the publishers nor the
+ * other subscribers. Everything runs on the given event loop.
+ */
+class Hub {
+public:
+	/**
+	 * @param io_context
+	 * @param queue_capacity the maximum number of bytes waiting to be sent to each subscriber. Publishers that send
+	 *        longer lines are disconnected
+	 * @param policy
+	 * @param log where connections, disconnections and overflows are reported, can be nullptr
+	 */
+	Hub(asio::io_context &io_context, std::size_t queue_capacity, OverflowPolicy policy, std::ostream *log);
+	Hub(const Hub &) = delete;
+	virtual ~Hub();
+
+	/**
+	 * Accept publishers on the given TCP address and port.
+	 */
+	void listen_publishers(const asio::ip::address &address, unsigned short port);
+
+	/**
+	 * Accept subscribers on the given TCP address and port.
+	 */
+	void listen_subscribers(const asio::ip::address &address, unsigned short port);
+
+	/**
+	 * Accept subscribers on a Unix socket with the given path. A stale socket with the same path is removed.
+	 */
+	void listen_subscribers(const std::string &path);
+
+	/**
+	 * Close all the connections and stop accepting new ones.
+	 */
+	void close();
+
+	uint64_t lines() const {
+		return _lines;
+	}
+
+	/**
+	 * Parse the name of a policy (drop-oldest or disconnect). Throws std::invalid_argument if there is no such policy.
+	 */
+	static OverflowPolicy parse_policy(const std::string &name);
+
+private:
+	class Publisher;
+	class Subscriber;
+	template<typename Protocol> class SocketSubscriber;
+
+	template<typename Acceptor> void _accept_subscribers(std::shared_ptr<Acceptor> acceptor);
+	void _accept_publishers();
+	void _broadcast(std::string_view lines);
+	void _remove(const std::shared_ptr<Subscriber> &subscriber);
+
+	asio::io_context &_io_context;
+	std::size_t _queue_capacity;
+	OverflowPolicy _policy;
+	std::ostream *_log;
+
+	std::unique_ptr<asio::ip::tcp::acceptor> _publisher_acceptor;
+	std::shared_ptr<asio::ip::tcp::acceptor> _tcp_acceptor;
+	std::shared_ptr<asio::local::stream_protocol::acceptor> _unix_acceptor;
+	std::string _unix_path;
+
+	std::set<std::shared_ptr<Publisher>> _publishers;
+	std::set<std::shared_ptr<Subscriber>> _subscribers;
+	uint64_t _next_id = 0;
+	uint64_t _lines = 0;
+};
+
+#endif /* HUB_H_ */
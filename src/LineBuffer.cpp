@@ -0,0 +1,118 @@
+/*
+ * LineBuffer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "LineBuffer.h"
+
+#include <cstring>
+
+LineBuffer::LineBuffer(std::size_t capacity, std::size_t max_line_length) :
+				_storage(capacity),
+				_max_line_length(max_line_length) {
+
+}
+
+bool LineBuffer::next_line(std::string_view &line) {
+	while(_skip_discarded()) {
+		const char *begin = _storage.data();
+		const char *newline = static_cast<const char*>(std::memchr(begin + _scan, '\n', _tail - _scan));
+		if(newline == nullptr) {
+			_scan = _tail;
+			_limit_line_length();
+			return false;
+		}
+
+		std::size_t end = newline - begin;
+		std::size_t start = _head;
+		_head = _scan = end + 1;
+		// a long line may have been received whole, in which case it was never pending incomplete
+		if(_max_line_length > 0 && end - start > _max_line_length) {
+			_discarded++;
+			continue;
+		}
+		line = std::string_view(begin + start, end - start);
+		return true;
+	}
+
+	return false;
+}
+
+bool LineBuffer::next_lines(std::string_view &lines) {
+	if(!_skip_discarded()) {
+		return false;
+	}
+
+	const char *begin = _storage.data();
+	// the last newline, which cannot come before the position the scan had reached
+	const char *newline = nullptr;
+	for(std::size_t i = _tail; i > _scan; i--) {
+		if(begin[i - 1] == '\n') {
+			newline = begin + i - 1;
+			break;
+		}
+	}
+	if(newline == nullptr) {
+		_scan = _tail;
+		_limit_line_length();
+		return false;
+	}
+
+	std::size_t end = newline - begin + 1;
+	lines = std::string_view(begin + _head, end - _head);
+	_head = _scan = end;
+
+	return true;
+}
+
+bool LineBuffer::_skip_discarded() {
+	if(!_skipping) {
+		return true;
+	}
+
+	const char *begin = _storage.data();
+	const char *newline = static_cast<const char*>(std::memchr(begin + _head, '\n', _tail - _head));
+	if(newline == nullptr) {
+		_head = _scan = _tail;
+		return false;
+	}
+	// resynchronise on the line that follows
+	_head = _scan = newline - begin + 1;
+	_skipping = false;
+	return true;
+}
+
+void LineBuffer::_limit_line_length() {
+	if(_max_line_length > 0 && _tail - _head > _max_line_length) {
+		_head = _scan = _tail;
+		_skipping = true;
+		_discarded++;
+	}
+}
+
+asio::mutable_buffer LineBuffer::prepare() {
+	if(_head == _tail) {
+		_head = _tail = _scan = 0;
+	}
+	else if(_tail == _storage.size()) {
+		if(_head > 0) {
+			// move the incomplete line to the front
+			std::memmove(_storage.data(), _storage.data() + _head, _tail - _head);
+			_tail -= _head;
+			_scan -= _head;
+			_head = 0;
+		}
+		else {
+			// the line does not fit in the buffer
+			_storage.resize(2 * _storage.size());
+		}
+	}
+
+	return asio::buffer(_storage.data() + _tail, _storage.size() - _tail);
+}
+
+void LineBuffer::commit(std::size_t n) {
+	_tail += n;
+}
@@ -0,0 +1,97 @@
+/*
+ * LineBuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef LINEBUFFER_H_
+#define LINEBUFFER_H_
+
+#include <asio/buffer.hpp>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * A persistent receive buffer that splits the incoming byte stream into newline-terminated lines.
+ *
+ * Bytes are appended at the tail by the socket and consumed line by line from the head. Bytes that follow the last
+ * complete line are kept for the next call, so that a single read can serve several lines. Lines are handed out as
+ * views on the internal storage and are therefore valid only until the next call to prepare().
+ *
+ * If a maximum line length is given, an incomplete line that grows beyond it is discarded and counted, and so are the
+ * bytes that follow it up to the next newline. The storage can therefore never grow without bound. next_line() also
+ * discards the longer lines that have been received whole, while next_lines() leaves them to the caller, which parses
+ * the burst anyway.
+ */
+class LineBuffer {
+public:
+	/**
+	 * @param capacity the initial size of the storage
+	 * @param max_line_length the length beyond which lines are discarded, 0 if there is no limit
+	 */
+	LineBuffer(std::size_t capacity = 65536, std::size_t max_line_length = 0);
+
+	/**
+	 * Extract the next complete line, if any.
+	 *
+	 * @param line set to a view on the line, without the trailing newline
+	 * @return true if a complete line was available, false otherwise
+	 */
+	bool next_line(std::string_view &line);
+
+	/**
+	 * Extract all the complete lines that are available in one go.
+	 *
+	 * @param lines set to a view on the lines, including the newline that terminates the last one
+	 * @return true if at least one complete line was available, false otherwise
+	 */
+	bool next_lines(std::string_view &lines);
+
+	/**
+	 * Return the free space at the tail of the buffer, into which new data can be read. The bytes that have already
+	 * been consumed are discarded and, if needed, the storage is enlarged.
+	 */
+	asio::mutable_buffer prepare();
+
+	/**
+	 * Mark the given number of bytes, previously read into the space returned by prepare(), as available.
+	 */
+	void commit(std::size_t n);
+
+	std::size_t pending() const {
+		return _tail - _head;
+	}
+
+	/**
+	 * Return the number of lines that have been discarded because they were too long.
+	 */
+	uint64_t discarded() const {
+		return _discarded;
+	}
+
+	/**
+	 * Return a view on the bytes that have been committed but not consumed yet.
+	 */
+	std::string_view pending_data() const {
+		return std::string_view(_storage.data() + _head, _tail - _head);
+	}
+
+private:
+	bool _skip_discarded();
+	void _limit_line_length();
+
+	std::vector<char> _storage;
+	std::size_t _max_line_length;
+	std::size_t _head = 0;
+	std::size_t _tail = 0;
+	// position from which the search for the next newline starts, so that each byte is scanned only once
+	std::size_t _scan = 0;
+	// true while the rest of a discarded line is being skipped
+	bool _skipping = false;
+	uint64_t _discarded = 0;
+};
+
+#endif /* LINEBUFFER_H_ */
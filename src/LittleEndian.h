@@ -0,0 +1,58 @@
+/*
+ * LittleEndian.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef LITTLEENDIAN_H_
+#define LITTLEENDIAN_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * Helpers that encode and decode numbers as little-endian bytes, independently of the byte order of the machine.
+ */
+namespace le {
+
+template<typename T>
+void put(std::string &out, T value) {
+	static_assert(std::is_integral<T>::value, "only integers can be encoded");
+	auto raw = static_cast<typename std::make_unsigned<T>::type>(value);
+	for(std::size_t i = 0; i < sizeof(T); i++) {
+		out += static_cast<char>((raw >> (8 * i)) & 0xff);
+	}
+}
+
+inline void put_double(std::string &out, double value) {
+	uint64_t raw;
+	std::memcpy(&raw, &value, sizeof(raw));
+	put(out, raw);
+}
+
+/**
+ * Decode a number from the given bytes, which must be at least sizeof(T) long.
+ */
+template<typename T>
+T get(const char *bytes) {
+	static_assert(std::is_integral<T>::value, "only integers can be decoded");
+	typename std::make_unsigned<T>::type raw = 0;
+	for(std::size_t i = 0; i < sizeof(T); i++) {
+		raw |= static_cast<decltype(raw)>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+	}
+	return static_cast<T>(raw);
+}
+
+inline double get_double(const char *bytes) {
+	uint64_t raw = get<uint64_t>(bytes);
+	double value;
+	std::memcpy(&value, &raw, sizeof(value));
+	return value;
+}
+
+}
+
+#endif /* LITTLEENDIAN_H_ */
@@ -0,0 +1,111 @@
+/*
+ * OutputWriter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "OutputWriter.h"
+
+#include <cerrno>
+#include <unistd.h>
+
+OutputWriter::OutputWriter(int fd, std::chrono::milliseconds max_latency, std::size_t capacity) :
+				_fd(fd),
+				_max_latency(max_latency),
+				_capacity(capacity) {
+	_line_buffered = isatty(fd);
+	_buffer.reserve(_capacity);
+	_spare.reserve(_capacity);
+
+	if(!_line_buffered) {
+		_thread = std::thread([this]() {
+			_flusher();
+		});
+	}
+}
+
+OutputWriter::~OutputWriter() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_cv.notify_one();
+	if(_thread.joinable()) {
+		_thread.join();
+	}
+
+	flush();
+}
+
+void OutputWriter::append(std::string_view data) {
+	bool full, first;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		first = _buffer.empty();
+		if(first) {
+			_oldest = std::chrono::steady_clock::now();
+		}
+		_buffer.append(data.data(), data.size());
+		full = _buffer.size() >= _capacity;
+	}
+
+	if(first && !_line_buffered) {
+		// let the flusher know when the data is due
+		_cv.notify_one();
+	}
+	if(full || _line_buffered) {
+		flush();
+	}
+}
+
+void OutputWriter::flush() {
+	std::lock_guard<std::mutex> write_lock(_write_mutex);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(_buffer.empty()) {
+			return;
+		}
+		_buffer.swap(_spare);
+	}
+
+	const char *data = _spare.data();
+	std::size_t left = _spare.size();
+	while(left > 0) {
+		ssize_t n = ::write(_fd, data, left);
+		if(n < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			// the reader has gone away, there is nothing we can do
+			break;
+		}
+		data += n;
+		left -= n;
+		_n_writes.fetch_add(1, std::memory_order_relaxed);
+	}
+	_spare.clear();
+}
+
+void OutputWriter::_flusher() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	while(!_stop) {
+		if(_buffer.empty()) {
+			// there is no deadline until a line is added
+			_cv.wait(lock, [this]() {
+				return _stop || !_buffer.empty();
+			});
+			continue;
+		}
+
+		auto deadline = _oldest + _max_latency;
+		if(std::chrono::steady_clock::now() < deadline) {
+			_cv.wait_until(lock, deadline);
+			continue;
+		}
+
+		lock.unlock();
+		flush();
+		lock.lock();
+	}
+}
@@ -0,0 +1,82 @@
+/*
+ * OutputWriter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef OUTPUTWRITER_H_
+#define OUTPUTWRITER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/**
+ * A buffered writer that batches many lines into a single write(2). The buffer is flushed when it is full and, in
+ * any case, no later than a given time after the oldest line it contains has been added. If the file descriptor is
+ * a terminal, each line is flushed as soon as it is added. Lines can be added from any thread.
+ */
+class OutputWriter {
+public:
+	/**
+	 * @param fd the file descriptor the output will be written to. It is not closed by the writer
+	 * @param max_latency the maximum time a line can spend in the buffer
+	 * @param capacity the size of the buffer, in bytes
+	 */
+	OutputWriter(int fd, std::chrono::milliseconds max_latency=std::chrono::milliseconds(50), std::size_t capacity=65536);
+	OutputWriter(const OutputWriter &) = delete;
+	virtual ~OutputWriter();
+
+	/**
+	 * Append a chunk of data (e.g. a line, including its trailing newline, or a binary record). Chunks are always
+	 * written as a whole.
+	 */
+	void append(std::string_view data);
+
+	/**
+	 * Write all the buffered lines.
+	 */
+	void flush();
+
+	bool line_buffered() const {
+		return _line_buffered;
+	}
+
+	/**
+	 * Return the number of write(2) calls issued so far.
+	 */
+	uint64_t n_writes() const {
+		return _n_writes.load(std::memory_order_relaxed);
+	}
+
+private:
+	void _flusher();
+
+	int _fd;
+	std::chrono::milliseconds _max_latency;
+	std::size_t _capacity;
+	bool _line_buffered;
+
+	// protects _buffer, _oldest and _stop
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	std::string _buffer;
+	std::chrono::steady_clock::time_point _oldest;
+	bool _stop = false;
+
+	// serialises the write(2) calls, so that lines are written in the same order as they have been added
+	std::mutex _write_mutex;
+	// the lines being written, swapped with _buffer on flush
+	std::string _spare;
+	std::atomic<uint64_t> _n_writes{0};
+
+	std::thread _thread;
+};
+
+#endif /* OUTPUTWRITER_H_ */
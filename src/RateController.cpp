@@ -0,0 +1,62 @@
+/*
+ * RateController.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "RateController.h"
+
+#include <algorithm>
+#include <sstream>
+
+RateController::RateController(const std::string &tag, std::chrono::microseconds target_latency, std::chrono::microseconds initial_period, std::chrono::microseconds min_period, std::chrono::microseconds max_period, std::ostream *log) :
+				_tag(tag),
+				_target(target_latency),
+				_period(initial_period),
+				_min_period(min_period),
+				_max_period(max_period),
+				_log(log) {
+
+}
+
+bool RateController::add_sample(std::chrono::microseconds rtt, uint64_t missed) {
+	_n_samples++;
+	_total_rtt += rtt;
+	if(_n_samples < WINDOW) {
+		return false;
+	}
+
+	auto mean_rtt = _total_rtt / _n_samples;
+	uint64_t window_missed = missed - _last_missed;
+	_last_missed = missed;
+	_n_samples = 0;
+	_total_rtt = std::chrono::microseconds(0);
+
+	auto old_period = _period;
+	std::string reason;
+	if(window_missed > 0 || mean_rtt > _target) {
+		_period = std::chrono::microseconds(static_cast<int64_t>(_period.count() * BACKOFF));
+		reason = (window_missed > 0) ? "backoff, missed deadlines" : "backoff, latency above target";
+		_slow_start = false;
+	}
+	else if(mean_rtt < _target * HEADROOM) {
+		double factor = (_slow_start) ? SLOW_START_SPEEDUP : SPEEDUP;
+		_period = std::chrono::microseconds(static_cast<int64_t>(_period.count() * factor));
+		reason = (_slow_start) ? "speedup, slow start" : "speedup";
+	}
+	else {
+		reason = "hold";
+	}
+	_period = std::clamp(_period, _min_period, _max_period);
+
+	if(_log != nullptr) {
+		// the line is written at once, since several controllers may share the same stream
+		std::stringstream ss;
+		ss << "# adaptive " << _tag << ": mean rtt " << mean_rtt.count() << " us, missed " << window_missed;
+		ss << ", period " << old_period.count() << " -> " << _period.count() << " us (" << reason << ")" << std::endl;
+		*_log << ss.str() << std::flush;
+	}
+
+	return _period != old_period;
+}
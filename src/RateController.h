@@ -0,0 +1,74 @@
+/*
+ * RateController.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef RATECONTROLLER_H_
+#define RATECONTROLLER_H_
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * Chooses the polling period of a device so as to poll it as fast as possible while keeping its response latency
+ * within a target budget.
+ *
+ * Samples are collected in windows. At the end of each window the controller shortens the period by a small factor if
+ * the mean round-trip time is comfortably below the target and no deadline has been missed, and backs off by a larger
+ * factor if the target has been exceeded or deadlines have been missed (i.e. if requests are queueing up). Until the
+ * first back-off the period is halved at each window, so that the controller quickly reaches the right order of magnitude.
+ */
+class RateController {
+public:
+	/**
+	 * @param tag the name used in the log
+	 * @param target_latency the maximum acceptable mean round-trip time
+	 * @param initial_period
+	 * @param min_period
+	 * @param max_period
+	 * @param log the stream decisions are logged to, or nullptr to disable logging
+	 */
+	RateController(const std::string &tag, std::chrono::microseconds target_latency, std::chrono::microseconds initial_period, std::chrono::microseconds min_period, std::chrono::microseconds max_period, std::ostream *log);
+
+	/**
+	 * Add a sample.
+	 *
+	 * @param rtt the round-trip time of the request
+	 * @param missed the total number of deadlines missed so far
+	 * @return true if the period has been changed
+	 */
+	bool add_sample(std::chrono::microseconds rtt, uint64_t missed);
+
+	std::chrono::microseconds period() const {
+		return _period;
+	}
+
+	/// the number of samples that make up a window
+	static constexpr unsigned int WINDOW = 10;
+	/// the period is multiplied by this factor when the device keeps up
+	static constexpr double SPEEDUP = 0.9;
+	/// the period is multiplied by this factor when the device keeps up and it has never fallen behind
+	static constexpr double SLOW_START_SPEEDUP = 0.5;
+	/// the period is multiplied by this factor when the device falls behind
+	static constexpr double BACKOFF = 1.5;
+	/// the period is shortened only if the mean latency is below this fraction of the target
+	static constexpr double HEADROOM = 0.8;
+
+private:
+	std::string _tag;
+	std::chrono::microseconds _target;
+	std::chrono::microseconds _period;
+	std::chrono::microseconds _min_period;
+	std::chrono::microseconds _max_period;
+	std::ostream *_log;
+
+	unsigned int _n_samples = 0;
+	std::chrono::microseconds _total_rtt{0};
+	uint64_t _last_missed = 0;
+	bool _slow_start = true;
+};
+
+#endif /* RATECONTROLLER_H_ */
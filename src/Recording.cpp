@@ -0,0 +1,345 @@
+/*
+ * Recording.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "Recording.h"
+
+#include "LittleEndian.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// the size of the fields of a column in the directory and in the footer
+constexpr std::size_t DIRECTORY_ENTRY_SIZE = 8;
+constexpr std::size_t FOOTER_ENTRY_SIZE = 20;
+
+int64_t epoch_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Reads little-endian fields from a buffer, checking that they do not go past its end.
+ */
+struct FieldReader {
+	const char *ptr;
+	const char *end;
+
+	const char *take(std::size_t n) {
+		if(static_cast<std::size_t>(end - ptr) < n) {
+			throw bad_recording("truncated chunk");
+		}
+		const char *field = ptr;
+		ptr += n;
+		return field;
+	}
+
+	template<typename T>
+	T get() {
+		return le::get<T>(take(sizeof(T)));
+	}
+};
+
+}
+
+int RecordingChunk::find(ColumnRole role, std::size_t channel) const {
+	std::size_t n_readings = 0;
+	for(std::size_t i = 0; i < columns.size(); i++) {
+		if(columns[i].role != role) {
+			continue;
+		}
+		if(role != ColumnRole::READINGS || n_readings++ == channel) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void RecordingChunk::decode(std::size_t column, std::vector<int64_t> &values) const {
+	const RecordingColumn &c = columns.at(column);
+	decode_int_column(std::string_view(data).substr(c.offset, c.size), c.encoding, n_samples, values);
+}
+
+void RecordingChunk::decode(std::size_t column, std::vector<double> &values) const {
+	const RecordingColumn &c = columns.at(column);
+	decode_double_column(std::string_view(data).substr(c.offset, c.size), c.encoding, n_samples, values);
+}
+
+RecordingWriter::RecordingWriter(const std::string &path, std::size_t n_devices, std::size_t chunk_size) :
+				_chunk_size((chunk_size > 0) ? chunk_size : 1),
+				_devices(n_devices) {
+	_file = std::fopen(path.c_str(), "wb");
+	if(_file == nullptr) {
+		throw bad_recording("cannot open '" + path + "': " + std::strerror(errno));
+	}
+
+	std::string header(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+	le::put(header, RECORDING_VERSION);
+	le::put(header, epoch_ns());
+	if(std::fwrite(header.data(), 1, header.size(), _file) != header.size()) {
+		std::string what = std::strerror(errno);
+		std::fclose(_file);
+		throw bad_recording("cannot write to '" + path + "': " + what);
+	}
+	_bytes = header.size();
+}
+
+RecordingWriter::~RecordingWriter() {
+	close();
+}
+
+void RecordingWriter::flush() {
+	if(_file == nullptr) {
+		return;
+	}
+
+	for(std::size_t slot = 0; slot < _devices.size(); slot++) {
+		if(_devices[slot].n_samples > 0) {
+			_write_chunk(slot, _devices[slot]);
+		}
+	}
+	if(std::fflush(_file) != 0) {
+		_set_error(std::string("cannot write the recording: ") + std::strerror(errno));
+	}
+}
+
+void RecordingWriter::close() {
+	if(_file == nullptr) {
+		return;
+	}
+
+	flush();
+	if(std::fclose(_file) != 0) {
+		_set_error(std::string("cannot close the recording: ") + std::strerror(errno));
+	}
+	_file = nullptr;
+}
+
+std::string RecordingWriter::error() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _error;
+}
+
+void RecordingWriter::_set_error(const std::string &what) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	// the first error is the meaningful one
+	if(_error.empty()) {
+		_error = what;
+	}
+}
+
+void RecordingWriter::write(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty, std::chrono::system_clock::time_point time) {
+	Device &device = _devices[slot];
+	bool has_uncertainty = uncertainty >= 0;
+
+	std::size_t n_columns = 2 + has_uncertainty + values.size();
+	if(device.n_samples > 0 && (device.columns.size() != n_columns || device.has_uncertainty != has_uncertainty)) {
+		_write_chunk(slot, device);
+	}
+
+	if(device.n_samples == 0) {
+		// set up the columns of a new chunk
+		device.device_id = device_id;
+		device.tag = tag;
+		device.has_uncertainty = has_uncertainty;
+		device.columns.resize(n_columns);
+		std::size_t idx = 0;
+		device.columns[idx++].role = ColumnRole::DELTA_TIME;
+		device.columns[idx++].role = ColumnRole::EPOCH_NS;
+		if(has_uncertainty) {
+			device.columns[idx++].role = ColumnRole::UNCERTAINTY;
+		}
+		for(std::size_t i = 0; i < values.size(); i++, idx++) {
+			device.columns[idx].role = ColumnRole::READINGS;
+			device.columns[idx].spec = schema[i];
+		}
+		for(auto &column : device.columns) {
+			column.ints.clear();
+			column.doubles.clear();
+		}
+	}
+
+	std::size_t idx = 0;
+	device.columns[idx++].ints.push_back(static_cast<int64_t>(delta_time));
+	device.columns[idx++].ints.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+	if(has_uncertainty) {
+		device.columns[idx++].ints.push_back(uncertainty);
+	}
+	for(std::size_t i = 0; i < values.size(); i++, idx++) {
+		if(schema[i].type == ChannelType::DOUBLE) {
+			device.columns[idx].doubles.push_back(values[i].d);
+		}
+		else {
+			device.columns[idx].ints.push_back(values[i].i);
+		}
+	}
+	device.n_samples++;
+
+	if(device.n_samples == _chunk_size) {
+		_write_chunk(slot, device);
+	}
+}
+
+void RecordingWriter::_write_chunk(std::size_t slot, Device &device) {
+	// the chunk is encoded by the thread that owns the device, and only the writing to the file is serialised
+	thread_local std::string directory, columns, footer, chunk;
+	directory.clear();
+	columns.clear();
+	footer.clear();
+
+	for(auto &column : device.columns) {
+		std::size_t before = columns.size();
+		ColumnEncoding encoding;
+		ColumnBound min, max;
+		uint32_t count = 0;
+		bool is_double = column.role == ColumnRole::READINGS && column.spec.type == ChannelType::DOUBLE;
+		if(is_double) {
+			encoding = encode_double_column(column.doubles, columns);
+			min.d = std::numeric_limits<double>::infinity();
+			max.d = -std::numeric_limits<double>::infinity();
+			for(auto value : column.doubles) {
+				if(!std::isnan(value)) {
+					min.d = std::min(min.d, value);
+					max.d = std::max(max.d, value);
+					count++;
+				}
+			}
+		}
+		else {
+			encoding = encode_int_column(column.ints, columns);
+			auto minmax = std::minmax_element(column.ints.begin(), column.ints.end());
+			min.i = *minmax.first;
+			max.i = *minmax.second;
+			count = column.ints.size();
+		}
+
+		le::put(directory, static_cast<uint8_t>(column.role));
+		le::put(directory, static_cast<uint8_t>(column.spec.type));
+		le::put(directory, static_cast<uint8_t>(column.spec.decimals));
+		le::put(directory, static_cast<uint8_t>(encoding));
+		le::put(directory, static_cast<uint32_t>(columns.size() - before));
+
+		if(is_double) {
+			le::put_double(footer, min.d);
+			le::put_double(footer, max.d);
+		}
+		else {
+			le::put(footer, min.i);
+			le::put(footer, max.i);
+		}
+		le::put(footer, count);
+	}
+
+	chunk.clear();
+	le::put(chunk, static_cast<uint16_t>(slot));
+	le::put(chunk, static_cast<int32_t>(device.device_id));
+	le::put(chunk, static_cast<uint16_t>(device.tag.size()));
+	chunk += device.tag;
+	le::put(chunk, static_cast<uint32_t>(device.n_samples));
+	le::put(chunk, static_cast<uint16_t>(device.columns.size()));
+	chunk += directory;
+	chunk += columns;
+	chunk += footer;
+
+	std::string header(RECORDING_CHUNK_MAGIC, sizeof(RECORDING_CHUNK_MAGIC));
+	le::put(header, static_cast<uint32_t>(chunk.size()));
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(!_error.empty()) {
+			_lost_samples += device.n_samples;
+		}
+		else if(std::fwrite(header.data(), 1, header.size(), _file) != header.size() || std::fwrite(chunk.data(), 1, chunk.size(), _file) != chunk.size()) {
+			_error = std::string("cannot write the recording: ") + std::strerror(errno);
+			_lost_samples += device.n_samples;
+		}
+		else {
+			_samples += device.n_samples;
+			_bytes += header.size() + chunk.size();
+		}
+	}
+
+	device.n_samples = 0;
+	for(auto &column : device.columns) {
+		column.ints.clear();
+		column.doubles.clear();
+	}
+}
+
+RecordingReader::RecordingReader(std::istream &input) :
+				_input(input) {
+	char header[sizeof(RECORDING_MAGIC) + 10];
+	if(!_input.read(header, sizeof(header)) || std::memcmp(header, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+		throw bad_recording("not a PADL recording");
+	}
+
+	uint16_t version = le::get<uint16_t>(header + sizeof(RECORDING_MAGIC));
+	if(version != RECORDING_VERSION) {
+		throw bad_recording("unsupported recording version " + std::to_string(version));
+	}
+	_start_time = le::get<int64_t>(header + sizeof(RECORDING_MAGIC) + 2);
+}
+
+bool RecordingReader::next(RecordingChunk &chunk) {
+	char header[8];
+	_input.read(header, sizeof(header));
+	if(_input.gcount() == 0) {
+		return false;
+	}
+	if(_input.gcount() != sizeof(header) || std::memcmp(header, RECORDING_CHUNK_MAGIC, sizeof(RECORDING_CHUNK_MAGIC)) != 0) {
+		throw bad_recording("invalid chunk header");
+	}
+
+	std::string body(le::get<uint32_t>(header + 4), '\0');
+	if(!_input.read(&body[0], body.size())) {
+		throw bad_recording("truncated chunk");
+	}
+
+	FieldReader reader{body.data(), body.data() + body.size()};
+	chunk.slot = reader.get<uint16_t>();
+	chunk.device_id = reader.get<int32_t>();
+	std::size_t tag_length = reader.get<uint16_t>();
+	chunk.tag.assign(reader.take(tag_length), tag_length);
+	chunk.n_samples = reader.get<uint32_t>();
+
+	chunk.columns.resize(reader.get<uint16_t>());
+	std::size_t offset = 0;
+	for(auto &column : chunk.columns) {
+		const char *entry = reader.take(DIRECTORY_ENTRY_SIZE);
+		column.role = static_cast<ColumnRole>(entry[0]);
+		column.spec.type = static_cast<ChannelType>(entry[1]);
+		column.spec.decimals = static_cast<uint8_t>(entry[2]);
+		column.encoding = static_cast<ColumnEncoding>(entry[3]);
+		column.offset = offset;
+		column.size = le::get<uint32_t>(entry + 4);
+		offset += column.size;
+		if(column.role > ColumnRole::READINGS || column.spec.type > ChannelType::FIXED || column.spec.decimals > MAX_DECIMALS) {
+			throw bad_recording("invalid column description");
+		}
+	}
+
+	chunk.data.assign(reader.take(offset), offset);
+
+	for(auto &column : chunk.columns) {
+		const char *entry = reader.take(FOOTER_ENTRY_SIZE);
+		if(column.is_double()) {
+			column.min.d = le::get_double(entry);
+			column.max.d = le::get_double(entry + 8);
+		}
+		else {
+			column.min.i = le::get<int64_t>(entry);
+			column.max.i = le::get<int64_t>(entry + 8);
+		}
+		column.count = le::get<uint32_t>(entry + 16);
+	}
+
+	return true;
+}
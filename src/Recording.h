@@ -0,0 +1,252 @@
+/*
+ * Recording.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef RECORDING_H_
+#define RECORDING_H_
+
+#include "channels.h"
+#include "ColumnCodec.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * A recording is a file header followed by a sequence of chunks, each containing up to a fixed number of samples of
+ * a single device stored column by column. All the numbers are little-endian.
+ *
+ * File header:
+ *   char[8]  magic, "PADLREC" followed by a null character
+ *   uint16   version
+ *   int64    start time, in nanoseconds since the Unix epoch
+ *
+ * Chunk:
+ *   char[4]  "CHNK"
+ *   uint32   size of the rest of the chunk, in bytes
+ *   uint16   slot of the device
+ *   int32    device id, or -1 if the device is the only one and its tag is not printed
+ *   uint16   length of the tag, followed by the tag
+ *   uint32   number of samples
+ *   uint16   number of columns, followed by the directory of the columns. For each column:
+ *              uint8   role (see ColumnRole)
+ *              uint8   type of the readings (see ChannelType), meaningful for READINGS columns only
+ *              uint8   number of decimal digits of the readings
+ *              uint8   encoding (see ColumnEncoding)
+ *              uint32  size of the encoded column, in bytes
+ *   the encoded columns, one after the other in the order of the directory
+ *   the footer, which contains the statistics of each column, in the same order:
+ *              int64 or double   minimum
+ *              int64 or double   maximum
+ *              uint32            number of values taken into account (NaNs are skipped)
+ *
+ * Columns of floating-point readings are encoded with XOR_VARINT, all the others with the best of DELTA_VARINT and
+ * DELTA_BITPACK.
+ */
+
+constexpr char RECORDING_MAGIC[8] = {'P', 'A', 'D', 'L', 'R', 'E', 'C', '\0'};
+constexpr uint16_t RECORDING_VERSION = 1;
+constexpr char RECORDING_CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+
+/**
+ * What a column of a chunk contains.
+ */
+enum class ColumnRole : uint8_t {
+	/// the delta_time of the samples, in microseconds
+	DELTA_TIME = 0,
+	/// the time at which the samples were recorded, in nanoseconds since the Unix epoch
+	EPOCH_NS = 1,
+	/// the timing uncertainty, in microseconds
+	UNCERTAINTY = 2,
+	/// the readings of a channel
+	READINGS = 3
+};
+
+class bad_recording: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * The minimum or maximum of a column: i for integer columns, d for floating-point ones.
+ */
+union ColumnBound {
+	int64_t i;
+	double d;
+};
+
+struct RecordingColumn {
+	ColumnRole role;
+	ChannelSpec spec;
+	ColumnEncoding encoding;
+	/// the position of the encoded column in RecordingChunk::data
+	std::size_t offset;
+	std::size_t size;
+	ColumnBound min;
+	ColumnBound max;
+	uint32_t count;
+
+	bool is_double() const {
+		return role == ColumnRole::READINGS && spec.type == ChannelType::DOUBLE;
+	}
+};
+
+struct RecordingChunk {
+	uint16_t slot = 0;
+	int32_t device_id = -1;
+	std::string tag;
+	std::size_t n_samples = 0;
+	std::vector<RecordingColumn> columns;
+	/// the encoded columns
+	std::string data;
+
+	/**
+	 * Return the index of the column with the given role (and, for readings, channel), or -1 if there is none.
+	 */
+	int find(ColumnRole role, std::size_t channel=0) const;
+
+	/**
+	 * Decode an integer column (everything but floating-point readings).
+	 */
+	void decode(std::size_t column, std::vector<int64_t> &values) const;
+
+	/**
+	 * Decode a column of floating-point readings.
+	 */
+	void decode(std::size_t column, std::vector<double> &values) const;
+};
+
+/**
+ * Collects the samples of each device into columns and writes them to a recording file one chunk at a time.
+ *
+ * Samples of different devices can be written concurrently, provided that the samples of each device are always
+ * written by the same thread.
+ */
+class RecordingWriter {
+public:
+	/**
+	 * Create the file and write its header. Throws bad_recording on error.
+	 *
+	 * @param path
+	 * @param n_devices the number of devices whose samples will be written
+	 * @param chunk_size the maximum number of samples per chunk
+	 */
+	RecordingWriter(const std::string &path, std::size_t n_devices, std::size_t chunk_size=4096);
+	RecordingWriter(const RecordingWriter &) = delete;
+
+	/**
+	 * Write all the chunks that are still being filled and close the file, if close() has not been called.
+	 */
+	virtual ~RecordingWriter();
+
+	/**
+	 * Add a sample of a device. A chunk is written when it is full or when the number of readings of the device
+	 * changes.
+	 *
+	 * @param slot the index of the device, smaller than n_devices
+	 * @param device_id the id that will be printed when converting the recording to text, or -1
+	 * @param tag
+	 * @param values
+	 * @param schema the types of the values
+	 * @param delta_time
+	 * @param uncertainty the timing uncertainty, or -1 if it is not available
+	 * @param time the time at which the sample was received
+	 */
+	void write(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty, std::chrono::system_clock::time_point time);
+
+	/**
+	 * Write the chunks that are still being filled. Should be called only when no other thread is writing samples.
+	 */
+	void flush();
+
+	/**
+	 * Write the chunks that are still being filled and close the file. No samples can be written afterwards.
+	 */
+	void close();
+
+	uint64_t samples() const {
+		return _samples;
+	}
+
+	uint64_t bytes() const {
+		return _bytes;
+	}
+
+	/**
+	 * Return the number of samples that could not be written because of an error.
+	 */
+	uint64_t lost_samples() const {
+		return _lost_samples;
+	}
+
+	/**
+	 * Return the description of the first error that occurred while writing or closing the file, or an empty
+	 * string. Nothing is written to the file after an error, since the chunks that follow a truncated one could not
+	 * be read anyway.
+	 */
+	std::string error() const;
+
+private:
+	struct Column {
+		ColumnRole role;
+		ChannelSpec spec;
+		std::vector<int64_t> ints;
+		std::vector<double> doubles;
+	};
+
+	struct Device {
+		int device_id = -1;
+		std::string tag;
+		bool has_uncertainty = false;
+		std::size_t n_samples = 0;
+		std::vector<Column> columns;
+	};
+
+	void _write_chunk(std::size_t slot, Device &device);
+	void _set_error(const std::string &what);
+
+	std::FILE *_file = nullptr;
+	std::size_t _chunk_size;
+	std::vector<Device> _devices;
+
+	// serialises the writing of the chunks and protects the counters
+	mutable std::mutex _mutex;
+	uint64_t _samples = 0;
+	uint64_t _bytes = 0;
+	uint64_t _lost_samples = 0;
+	std::string _error;
+};
+
+/**
+ * Reads the chunks of a recording.
+ */
+class RecordingReader {
+public:
+	/**
+	 * Read the file header. Throws bad_recording if the stream does not contain a recording.
+	 */
+	RecordingReader(std::istream &input);
+
+	/**
+	 * Read the next chunk. Throws bad_recording if the recording is corrupted.
+	 *
+	 * @return false if there are no more chunks
+	 */
+	bool next(RecordingChunk &chunk);
+
+	int64_t start_time() const {
+		return _start_time;
+	}
+
+private:
+	std::istream &_input;
+	int64_t _start_time = 0;
+};
+
+#endif /* RECORDING_H_ */
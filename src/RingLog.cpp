@@ -0,0 +1,194 @@
+/*
+ * RingLog.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "RingLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+constexpr long HUGETLBFS_MAGIC = 0x958458f6;
+#endif
+
+std::string system_error(const std::string &what, const std::string &path) {
+	return what + " '" + path + "': " + std::strerror(errno);
+}
+
+std::size_t round_up(std::size_t value, std::size_t multiple) {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+}
+
+RingLogWriter::RingLogWriter(const std::string &path, uint64_t n_slots, uint32_t slot_size) {
+	if(n_slots == 0) {
+		throw bad_ring_log("the ring log should have at least one slot");
+	}
+	// slots are aligned to the size of a cache line
+	slot_size = round_up(std::max<std::size_t>(slot_size, sizeof(RingSlot) + 1), 64);
+	std::size_t slots_offset = round_up(sizeof(RingHeader), 64);
+
+	int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		throw bad_ring_log(system_error("cannot open the ring log", path));
+	}
+
+	_size = slots_offset + n_slots * slot_size;
+#ifdef __linux__
+	// files on hugetlbfs can only be mapped in multiples of the huge page size
+	struct statfs fs;
+	if(fstatfs(fd, &fs) == 0 && static_cast<long>(fs.f_type) == HUGETLBFS_MAGIC) {
+		_size = round_up(_size, fs.f_bsize);
+	}
+#endif
+
+	if(ftruncate(fd, _size) != 0) {
+		close(fd);
+		throw bad_ring_log(system_error("cannot resize the ring log", path));
+	}
+
+	_memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(_memory == MAP_FAILED) {
+		_memory = nullptr;
+		throw bad_ring_log(system_error("cannot map the ring log", path));
+	}
+
+	// the file has just been truncated, so all the slot markers are zero and no record looks complete
+	_header = new (_memory) RingHeader;
+	_header->version = RING_VERSION;
+	_header->slot_size = slot_size;
+	_header->n_slots = n_slots;
+	_header->slots_offset = slots_offset;
+	_header->cursor.store(0, std::memory_order_relaxed);
+	_slots = static_cast<char*>(_memory) + slots_offset;
+
+	// readers recognise the file only once the magic has been written
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(_header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+}
+
+RingLogWriter::~RingLogWriter() {
+	if(_memory != nullptr) {
+		munmap(_memory, _size);
+	}
+}
+
+void RingLogWriter::append(std::string_view record) {
+	uint32_t capacity = _header->slot_size - sizeof(RingSlot);
+	if(record.size() > capacity) {
+		record = record.substr(0, capacity);
+		_truncated.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint64_t sequence = _header->cursor.fetch_add(1, std::memory_order_relaxed);
+	auto *slot = reinterpret_cast<RingSlot*>(_slots + (sequence % _header->n_slots) * _header->slot_size);
+
+	slot->marker.store(2 * sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot->length = record.size();
+	std::memcpy(reinterpret_cast<char*>(slot + 1), record.data(), record.size());
+	slot->marker.store(2 * sequence + 2, std::memory_order_release);
+}
+
+RingLogReader::RingLogReader(const std::string &path, bool from_start) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		throw bad_ring_log(system_error("cannot open the ring log", path));
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(RingHeader)) {
+		close(fd);
+		throw bad_ring_log("'" + path + "' is not a ring log");
+	}
+	_size = st.st_size;
+
+	_memory = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(_memory == MAP_FAILED) {
+		_memory = nullptr;
+		throw bad_ring_log(system_error("cannot map the ring log", path));
+	}
+
+	_header = static_cast<const RingHeader*>(_memory);
+	if(std::memcmp(_header->magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0 || _header->version != RING_VERSION) {
+		munmap(_memory, _size);
+		_memory = nullptr;
+		throw bad_ring_log("'" + path + "' is not a ring log");
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if(_header->slots_offset + _header->n_slots * _header->slot_size > _size) {
+		munmap(_memory, _size);
+		_memory = nullptr;
+		throw bad_ring_log("the ring log '" + path + "' is truncated");
+	}
+	_slots = static_cast<const char*>(_memory) + _header->slots_offset;
+
+	uint64_t cursor = _header->cursor.load(std::memory_order_acquire);
+	if(from_start) {
+		_next = (cursor > _header->n_slots) ? cursor - _header->n_slots : 0;
+	}
+	else {
+		_next = cursor;
+	}
+}
+
+RingLogReader::~RingLogReader() {
+	if(_memory != nullptr) {
+		munmap(_memory, _size);
+	}
+}
+
+bool RingLogReader::next(std::string &record) {
+	while(true) {
+		uint64_t cursor = _header->cursor.load(std::memory_order_acquire);
+		if(_next >= cursor) {
+			return false;
+		}
+		// the writer has lapped us
+		if(cursor - _next > _header->n_slots) {
+			_lost += cursor - _header->n_slots - _next;
+			_next = cursor - _header->n_slots;
+		}
+
+		auto *slot = reinterpret_cast<const RingSlot*>(_slots + (_next % _header->n_slots) * _header->slot_size);
+		uint64_t complete = 2 * _next + 2;
+		uint64_t marker = slot->marker.load(std::memory_order_acquire);
+		if(marker < complete) {
+			// the record has been claimed but has not been completed yet
+			return false;
+		}
+
+		if(marker == complete) {
+			uint32_t length = std::min<uint32_t>(slot->length, _header->slot_size - sizeof(RingSlot));
+			record.assign(reinterpret_cast<const char*>(slot + 1), length);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(slot->marker.load(std::memory_order_relaxed) == complete) {
+				_next++;
+				return true;
+			}
+		}
+
+		// the record has been overwritten while we were looking at it
+		_lost++;
+		_next++;
+	}
+}
@@ -0,0 +1,128 @@
+/*
+ * RingLog.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef RINGLOG_H_
+#define RINGLOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/*
+ * A ring log is a file made of a header followed by a fixed number of fixed-size slots, each holding one record.
+ * The file is memory-mapped by the writer and by any number of readers, which never take locks and never make
+ * system calls to exchange records.
+ *
+ * The header contains the number of records written so far (the write cursor). The record with sequence number s
+ * is stored in the slot s % n_slots, whose marker is set to 2s + 1 while the record is being written and to 2s + 2
+ * once it is complete. A reader that wants record s waits for the marker to become 2s + 2, copies the record and
+ * checks that the marker has not changed in the meantime: if it has, the record has been overwritten and is lost.
+ */
+
+constexpr char RING_MAGIC[8] = {'P', 'A', 'D', 'L', 'R', 'I', 'N', 'G'};
+constexpr uint32_t RING_VERSION = 1;
+
+struct RingHeader {
+	char magic[8];
+	uint32_t version;
+	/// the size of each slot, including its RingSlot header
+	uint32_t slot_size;
+	uint64_t n_slots;
+	/// the offset of the first slot from the beginning of the file
+	uint64_t slots_offset;
+	/// the number of records that have been claimed by writers
+	alignas(64) std::atomic<uint64_t> cursor;
+};
+
+struct RingSlot {
+	std::atomic<uint64_t> marker;
+	/// the length of the record that follows
+	uint32_t length;
+	uint32_t reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring log requires lock-free 64-bit atomics");
+
+class bad_ring_log: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * The writing end of a ring log. Records can be appended concurrently by several threads.
+ */
+class RingLogWriter {
+public:
+	/**
+	 * Create (or truncate) the ring log file and map it in memory. If the file lives on a hugetlbfs mount, its size
+	 * is rounded up to a multiple of the huge page size. Throws bad_ring_log on error.
+	 *
+	 * @param path
+	 * @param n_slots the number of records the ring can hold
+	 * @param slot_size the size of each slot in bytes, which limits the length of the records
+	 */
+	RingLogWriter(const std::string &path, uint64_t n_slots=65536, uint32_t slot_size=256);
+	RingLogWriter(const RingLogWriter &) = delete;
+	virtual ~RingLogWriter();
+
+	/**
+	 * Append a record. Records longer than the slot are truncated.
+	 */
+	void append(std::string_view record);
+
+	uint64_t truncated() const {
+		return _truncated.load(std::memory_order_relaxed);
+	}
+
+private:
+	void *_memory = nullptr;
+	std::size_t _size = 0;
+	RingHeader *_header = nullptr;
+	char *_slots = nullptr;
+	std::atomic<uint64_t> _truncated{0};
+};
+
+/**
+ * The reading end of a ring log. Each reader keeps its own position and never interferes with the writer.
+ */
+class RingLogReader {
+public:
+	/**
+	 * Map an existing ring log. Throws bad_ring_log on error.
+	 *
+	 * @param path
+	 * @param from_start if true, start from the oldest record still in the ring, otherwise from the next one
+	 */
+	RingLogReader(const std::string &path, bool from_start=false);
+	RingLogReader(const RingLogReader &) = delete;
+	virtual ~RingLogReader();
+
+	/**
+	 * Copy the next record, if it is available.
+	 *
+	 * @return false if no new record has been completed yet
+	 */
+	bool next(std::string &record);
+
+	/**
+	 * Return the number of records that have been overwritten before this reader could copy them.
+	 */
+	uint64_t lost() const {
+		return _lost;
+	}
+
+private:
+	void *_memory = nullptr;
+	std::size_t _size = 0;
+	const RingHeader *_header = nullptr;
+	const char *_slots = nullptr;
+	uint64_t _next = 0;
+	uint64_t _lost = 0;
+};
+
+#endif /* RINGLOG_H_ */
@@ -0,0 +1,39 @@
+/*
+ * Sample.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef SAMPLE_H_
+#define SAMPLE_H_
+
+#include "channels.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A sample as it travels from the thread that polls the device to the threads of the sinks. The tag and the schema
+ * are not copied, hence they must outlive the SinkFanOut the sample is published to.
+ */
+struct Sample {
+	/// the index of the device
+	std::size_t slot = 0;
+	/// the id printed in front of the sample, or -1 if there is only one device and no tag should be printed
+	int device_id = -1;
+	const std::string *tag = nullptr;
+	const ChannelSchema *schema = nullptr;
+	std::vector<ChannelValue> values;
+	uint64_t delta_time = 0;
+	/// the timing uncertainty, or -1 if it is not available
+	int64_t uncertainty = -1;
+	/// the time at which the sample was published
+	std::chrono::system_clock::time_point time;
+	/// the same time on the monotonic clock, from which relative times are computed
+	std::chrono::steady_clock::time_point steady_time;
+};
+
+#endif /* SAMPLE_H_ */
@@ -0,0 +1,138 @@
+/*
+ * SampleBlock.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "SampleBlock.h"
+
+#include <cstring>
+
+SampleBlock::SampleBlock(std::size_t capacity) :
+				_capacity((capacity > 0) ? capacity : 1),
+				_timestamps(_capacity) {
+
+}
+
+void SampleBlock::clear() {
+	_n_samples = 0;
+	_n_channels = 0;
+}
+
+bool SampleBlock::append(uint64_t timestamp, const std::vector<ChannelValue> &values) {
+	if(full()) {
+		return false;
+	}
+
+	if(_n_samples == 0) {
+		_n_channels = values.size();
+		if(_values.size() < _n_channels * _capacity) {
+			_values.resize(_n_channels * _capacity);
+		}
+	}
+	else if(values.size() != _n_channels) {
+		return false;
+	}
+
+	_timestamps[_n_samples] = timestamp;
+	ChannelValue *dest = _values.data() + _n_samples;
+	for(std::size_t channel = 0; channel < _n_channels; channel++) {
+		dest[channel * _capacity] = values[channel];
+	}
+	_n_samples++;
+
+	return true;
+}
+
+void SampleBlock::row(std::size_t sample, std::vector<ChannelValue> &values) const {
+	values.resize(_n_channels);
+	for(std::size_t channel = 0; channel < _n_channels; channel++) {
+		values[channel] = _values[channel * _capacity + sample];
+	}
+}
+
+BlockParser::BlockParser(LayoutParser parser, const ChannelSchema &schema, uint64_t channel_mask, utils::TokenizerISA isa) :
+				_parser(parser),
+				_schema(schema),
+				_channel_mask(channel_mask),
+				_tokenized(parser == layout_parser("dl")),
+				_isa(isa) {
+
+}
+
+std::size_t BlockParser::parse(std::string_view buffer, uint64_t timestamp, SampleBlock &block) {
+	if(_tokenized) {
+		return _parse_tokenized(buffer, timestamp, block);
+	}
+
+	const char *begin = buffer.data();
+	const char *ptr = begin;
+	const char *end = begin + buffer.size();
+
+	while(ptr < end && !block.full()) {
+		auto newline = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+		if(newline == nullptr) {
+			break;
+		}
+
+		std::size_t n_bad = _parser(std::string_view(ptr, newline - ptr), _values, _schema, _channel_mask);
+		if(!_accept(n_bad, timestamp, block)) {
+			// the line will be parsed again into a new block
+			break;
+		}
+
+		ptr = newline + 1;
+	}
+
+	return ptr - begin;
+}
+
+std::size_t BlockParser::_parse_tokenized(std::string_view buffer, uint64_t timestamp, SampleBlock &block) {
+	const char *begin = buffer.data();
+	// the lines tokenized by the previous call are reused if this is the rest of the same buffer
+	if(begin != _next || _next_line >= _lines.n_lines() || begin + buffer.size() < _lines_end) {
+		auto last_newline = buffer.rfind('\n');
+		if(last_newline == std::string_view::npos) {
+			return 0;
+		}
+		utils::tokenize_lines(buffer.substr(0, last_newline + 1), ",", _lines, _isa);
+		_lines_base = begin;
+		_lines_end = begin + last_newline + 1;
+		_next_line = 0;
+	}
+
+	std::string_view source(_lines_base, _lines_end - _lines_base);
+	const char *ptr = begin;
+	while(_next_line < _lines.n_lines() && !block.full()) {
+		uint32_t first = _lines.line_offsets[_next_line];
+		uint32_t last = _lines.line_offsets[_next_line + 1];
+		std::size_t n_bad = parse_fields(source, _lines.tokens.data() + first, last - first, _values, _schema, _channel_mask);
+		if(!_accept(n_bad, timestamp, block)) {
+			break;
+		}
+
+		// the last field of a line ends at its newline
+		const utils::Token &last_field = _lines.tokens[last - 1];
+		ptr = _lines_base + last_field.begin + last_field.length + 1;
+		_next_line++;
+	}
+	_next = ptr;
+
+	return ptr - begin;
+}
+
+bool BlockParser::_accept(std::size_t n_bad, uint64_t timestamp, SampleBlock &block) {
+	// like in the request/response path, an empty line is a sample without readings rather than a bad one
+	if(n_bad > 0) {
+		_samples++;
+		_bad_samples++;
+		_bad_readings += n_bad;
+		return true;
+	}
+	if(block.append(timestamp, _values)) {
+		_samples++;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,146 @@
+/*
+ * SampleBlock.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef SAMPLEBLOCK_H_
+#define SAMPLEBLOCK_H_
+
+#include "channels.h"
+#include "parser.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * A block of samples stored column-wise: a column of timestamps and one contiguous column of readings per channel.
+ * All the samples of a block have the same number of readings, which is set by the first sample appended after a
+ * call to clear(). The storage is allocated once and reused across blocks.
+ */
+class SampleBlock {
+public:
+	SampleBlock(std::size_t capacity = 1024);
+
+	/**
+	 * Remove all the samples. The number of channels will be set by the next sample.
+	 */
+	void clear();
+
+	/**
+	 * Append a sample to the block.
+	 *
+	 * @return false if the block is full or if the sample has a different number of readings than the other ones
+	 */
+	bool append(uint64_t timestamp, const std::vector<ChannelValue> &values);
+
+	std::size_t size() const {
+		return _n_samples;
+	}
+
+	std::size_t capacity() const {
+		return _capacity;
+	}
+
+	bool empty() const {
+		return _n_samples == 0;
+	}
+
+	bool full() const {
+		return _n_samples == _capacity;
+	}
+
+	std::size_t n_channels() const {
+		return _n_channels;
+	}
+
+	const uint64_t *timestamps() const {
+		return _timestamps.data();
+	}
+
+	/**
+	 * Return the readings of the given channel, one per sample.
+	 */
+	const ChannelValue *column(std::size_t channel) const {
+		return _values.data() + channel * _capacity;
+	}
+
+	/**
+	 * Copy the readings of the given sample into values.
+	 */
+	void row(std::size_t sample, std::vector<ChannelValue> &values) const;
+
+private:
+	std::size_t _capacity;
+	std::size_t _n_samples = 0;
+	std::size_t _n_channels = 0;
+	std::vector<uint64_t> _timestamps;
+	// the columns are stored one after the other, each _capacity readings long
+	std::vector<ChannelValue> _values;
+};
+
+/**
+ * Parse buffers made of many newline-terminated responses into blocks of samples. With the "dl" layout, the fields of
+ * all the lines of a buffer are found in a single vectorised pass by utils::tokenize_lines.
+ */
+class BlockParser {
+public:
+	/**
+	 * @param parser the parser of the layout of the responses
+	 * @param schema the types of the channels
+	 * @param channel_mask the channels to be converted and stored
+	 * @param isa the instruction set used to split the lines of the "dl" layout into fields
+	 */
+	BlockParser(LayoutParser parser, const ChannelSchema &schema, uint64_t channel_mask=ALL_CHANNELS, utils::TokenizerISA isa=utils::TokenizerISA::AUTO);
+
+	/**
+	 * Parse the complete lines of the buffer and append them to the block, all with the same timestamp. Samples
+	 * that contain bad readings are counted and dropped. Parsing stops when the block is full or when a sample
+	 * has a different number of readings than those already in the block, in which case the block should be
+	 * consumed and cleared before parsing the rest of the buffer, which should be passed unchanged to the next call.
+	 *
+	 * @param buffer the lines. The characters that follow the last newline are ignored
+	 * @param timestamp
+	 * @param block
+	 * @return the number of bytes of the buffer that have been consumed
+	 */
+	std::size_t parse(std::string_view buffer, uint64_t timestamp, SampleBlock &block);
+
+	uint64_t samples() const {
+		return _samples;
+	}
+
+	uint64_t bad_samples() const {
+		return _bad_samples;
+	}
+
+	uint64_t bad_readings() const {
+		return _bad_readings;
+	}
+
+private:
+	std::size_t _parse_tokenized(std::string_view buffer, uint64_t timestamp, SampleBlock &block);
+	bool _accept(std::size_t n_bad, uint64_t timestamp, SampleBlock &block);
+
+	LayoutParser _parser;
+	const ChannelSchema &_schema;
+	uint64_t _channel_mask;
+	// whether the lines are split into fields by the tokenizer
+	bool _tokenized;
+	utils::TokenizerISA _isa;
+	// the readings of the line being parsed
+	std::vector<ChannelValue> _values;
+	// the fields of the complete lines of the last buffer, which are kept if parsing stops before the end of it
+	utils::TokenizedLines _lines;
+	const char *_lines_base = nullptr;
+	const char *_lines_end = nullptr;
+	const char *_next = nullptr;
+	std::size_t _next_line = 0;
+	uint64_t _samples = 0;
+	uint64_t _bad_samples = 0;
+	uint64_t _bad_readings = 0;
+};
+
+#endif /* SAMPLEBLOCK_H_ */
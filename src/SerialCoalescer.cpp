@@ -0,0 +1,198 @@
+/*
+ * SerialCoalescer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "SerialCoalescer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// the budget can be spent in bursts of this many seconds of line time
+constexpr double BURST_SECONDS = 0.1;
+
+double as_double(ChannelValue value, const ChannelSpec &spec) {
+	return (spec.type == ChannelType::DOUBLE) ? value.d : value.i;
+}
+
+}
+
+SerialCoalescer::SerialCoalescer(std::size_t n_devices, double bytes_per_second, CoalesceMode mode) :
+				_bytes_per_second(bytes_per_second),
+				_burst(std::max(bytes_per_second * BURST_SECONDS, 1.0)),
+				_mode(mode),
+				_pending(n_devices),
+				_budget(_burst) {
+
+}
+
+CoalesceMode SerialCoalescer::parse_mode(const std::string &name) {
+	if(name == "latest") {
+		return CoalesceMode::LATEST;
+	}
+	if(name == "min") {
+		return CoalesceMode::MIN;
+	}
+	if(name == "max") {
+		return CoalesceMode::MAX;
+	}
+	if(name == "mean") {
+		return CoalesceMode::MEAN;
+	}
+	throw std::invalid_argument("unknown coalescing mode '" + name + "' (should be latest, min, max or mean)");
+}
+
+void SerialCoalescer::add(const Sample &sample) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto now = std::chrono::steady_clock::now();
+	if(!_started) {
+		_started = true;
+		_first_sample = now;
+		_refilled = now;
+	}
+	_last_sample = now;
+
+	Pending &pending = _pending[sample.slot];
+	pending.samples++;
+	_merge(pending, sample);
+}
+
+bool SerialCoalescer::next(Sample &frame, std::chrono::steady_clock::duration &wait) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::size_t n_devices = _pending.size();
+	std::size_t slot = 0;
+	while(slot < n_devices && _pending[(_turn + slot) % n_devices].n_samples == 0) {
+		slot++;
+	}
+	if(slot == n_devices) {
+		wait = std::chrono::steady_clock::duration::max();
+		return false;
+	}
+	slot = (_turn + slot) % n_devices;
+
+	auto now = std::chrono::steady_clock::now();
+	_budget = std::min(_budget + std::chrono::duration<double>(now - _refilled).count() * _bytes_per_second, _burst);
+	_refilled = now;
+	// the budget is allowed to go negative by one frame, whose size is not known yet
+	if(_budget <= 0) {
+		wait = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(-_budget / _bytes_per_second)) + std::chrono::microseconds(1);
+		return false;
+	}
+
+	_emit(_pending[slot], frame);
+	_turn = slot + 1;
+	return true;
+}
+
+void SerialCoalescer::sent(std::size_t bytes) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_budget -= bytes;
+	_bytes += bytes;
+}
+
+bool SerialCoalescer::take(std::size_t slot, Sample &frame) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	Pending &pending = _pending[slot];
+	if(pending.n_samples == 0) {
+		return false;
+	}
+	_emit(pending, frame);
+	return true;
+}
+
+void SerialCoalescer::print_stats(std::ostream &out) const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	uint64_t samples = 0;
+	uint64_t frames = 0;
+	for(auto &pending : _pending) {
+		samples += pending.samples;
+		frames += pending.frames;
+	}
+
+	double elapsed = std::chrono::duration<double>(_last_sample - _first_sample).count();
+	double frame_rate = (elapsed > 0) ? frames / elapsed : 0;
+	double byte_rate = (elapsed > 0) ? _bytes / elapsed : 0;
+	out << "Serial line, budget: " << std::lround(_bytes_per_second) << " bytes/s, used: " << std::lround(byte_rate) << " bytes/s, frames: " << frames << " (" << std::lround(frame_rate) << " frames/s), coalesced samples: " << samples - frames << std::endl;
+	if(_pending.size() > 1) {
+		for(auto &pending : _pending) {
+			if(pending.samples == 0) {
+				continue;
+			}
+			out << "Serial line, " << *pending.sample.tag << ", frames: " << pending.frames << ", coalesced samples: " << pending.samples - pending.frames << std::endl;
+		}
+	}
+}
+
+void SerialCoalescer::_merge(Pending &pending, const Sample &sample) {
+	if(pending.n_samples == 0 || _mode == CoalesceMode::LATEST) {
+		// the samples of a device always have the same number of readings
+		pending.sample.values.assign(sample.values.begin(), sample.values.end());
+		if(_mode == CoalesceMode::MEAN) {
+			pending.sums.resize(sample.values.size());
+			for(std::size_t c = 0; c < sample.values.size(); c++) {
+				pending.sums[c] = as_double(sample.values[c], (*sample.schema)[c]);
+			}
+		}
+	}
+	else {
+		std::size_t n = std::min(pending.sample.values.size(), sample.values.size());
+		for(std::size_t c = 0; c < n; c++) {
+			const ChannelSpec &spec = (*sample.schema)[c];
+			ChannelValue &merged = pending.sample.values[c];
+			ChannelValue value = sample.values[c];
+			if(_mode == CoalesceMode::MEAN) {
+				pending.sums[c] += as_double(value, spec);
+			}
+			else if(spec.type == ChannelType::DOUBLE) {
+				// NaN readings are ignored unless there is nothing else
+				merged.d = (_mode == CoalesceMode::MIN) ? std::fmin(merged.d, value.d) : std::fmax(merged.d, value.d);
+			}
+			else {
+				merged.i = (_mode == CoalesceMode::MIN) ? std::min(merged.i, value.i) : std::max(merged.i, value.i);
+			}
+		}
+	}
+
+	// the timing and the identity of the frame are those of the newest sample
+	pending.sample.slot = sample.slot;
+	pending.sample.device_id = sample.device_id;
+	pending.sample.tag = sample.tag;
+	pending.sample.schema = sample.schema;
+	pending.sample.delta_time = sample.delta_time;
+	pending.sample.uncertainty = sample.uncertainty;
+	pending.sample.time = sample.time;
+	pending.sample.steady_time = sample.steady_time;
+	pending.n_samples++;
+}
+
+void SerialCoalescer::_emit(Pending &pending, Sample &frame) {
+	if(_mode == CoalesceMode::MEAN) {
+		for(std::size_t c = 0; c < pending.sample.values.size(); c++) {
+			double mean = pending.sums[c] / pending.n_samples;
+			ChannelValue &value = pending.sample.values[c];
+			if((*pending.sample.schema)[c].type == ChannelType::DOUBLE) {
+				value.d = mean;
+			}
+			else {
+				value.i = static_cast<int32_t>(std::llround(mean));
+			}
+		}
+	}
+
+	frame.slot = pending.sample.slot;
+	frame.device_id = pending.sample.device_id;
+	frame.tag = pending.sample.tag;
+	frame.schema = pending.sample.schema;
+	frame.values.assign(pending.sample.values.begin(), pending.sample.values.end());
+	frame.delta_time = pending.sample.delta_time;
+	frame.uncertainty = pending.sample.uncertainty;
+	frame.time = pending.sample.time;
+	frame.steady_time = pending.sample.steady_time;
+	pending.n_samples = 0;
+	pending.frames++;
+}
@@ -0,0 +1,135 @@
+/*
+ * SerialCoalescer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef SERIALCOALESCER_H_
+#define SERIALCOALESCER_H_
+
+#include "Sample.h"
+#include "SerialWriter.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * How the samples that arrive while the serial line is busy are merged into the next frame.
+ */
+enum class CoalesceMode {
+	/// send the newest sample only
+	LATEST,
+	/// send the smallest reading of each channel
+	MIN,
+	/// send the largest reading of each channel
+	MAX,
+	/// send the average of the readings of each channel
+	MEAN
+};
+
+/**
+ * Keeps the frames sent over a serial line within the number of bytes per second the line can carry. Samples are
+ * merged, device by device, for as long as the line has no room for another frame, so that the receiver always gets
+ * recent readings rather than a backlog that grows without bound or bytes dropped at random. Whenever the line has
+ * room, the devices whose samples are waiting take turns, hence none of them is starved by the others.
+ */
+class SerialCoalescer {
+public:
+	/**
+	 * @param n_devices
+	 * @param bytes_per_second the budget of the line, see line_rate
+	 * @param mode
+	 */
+	SerialCoalescer(std::size_t n_devices, double bytes_per_second, CoalesceMode mode);
+	SerialCoalescer(const SerialCoalescer &) = delete;
+
+	/**
+	 * Return the mode with the given name (latest, min, max or mean). Throws std::invalid_argument if there is none.
+	 */
+	static CoalesceMode parse_mode(const std::string &name);
+
+	/**
+	 * Return the number of bytes per second a line with the given baud rate and framing can carry.
+	 */
+	static double line_rate(unsigned int baud_rate, const SerialMode &mode) {
+		return static_cast<double>(baud_rate) / mode.bits_per_character();
+	}
+
+	std::size_t n_devices() const {
+		return _pending.size();
+	}
+
+	/**
+	 * Add a sample, which is merged with the samples of the same device that have not been sent yet. Can be called
+	 * concurrently by several threads.
+	 */
+	void add(const Sample &sample);
+
+	/**
+	 * Take the merged samples of the next device in turn, if the line has room for a new frame.
+	 *
+	 * @param frame where the samples of the device merged since its last frame are stored
+	 * @param wait set to the time after which the line will have room for a frame if there are samples waiting, to
+	 * its maximum otherwise
+	 * @return true if frame should be sent now, in which case sent() should be called once it has been formatted
+	 */
+	bool next(Sample &frame, std::chrono::steady_clock::duration &wait);
+
+	/**
+	 * Charge a frame of the given size to the budget of the line.
+	 */
+	void sent(std::size_t bytes);
+
+	/**
+	 * Take the samples of the given device that have been merged but not sent yet (e.g. when the line is closed).
+	 *
+	 * @return false if there are none
+	 */
+	bool take(std::size_t slot, Sample &frame);
+
+	/**
+	 * Print the budget of the line, the number and rate of the frames and the number of merged samples, in total and
+	 * for each device.
+	 */
+	void print_stats(std::ostream &out) const;
+
+private:
+	/**
+	 * The samples of a device that have not been sent yet.
+	 */
+	struct Pending {
+		uint64_t n_samples = 0;
+		Sample sample;
+		// the sum of the readings of each channel, for CoalesceMode::MEAN
+		std::vector<double> sums;
+		uint64_t samples = 0;
+		uint64_t frames = 0;
+	};
+
+	void _merge(Pending &pending, const Sample &sample);
+	void _emit(Pending &pending, Sample &frame);
+
+	double _bytes_per_second;
+	double _burst;
+	CoalesceMode _mode;
+
+	// protects the samples of the devices, the budget and the times below
+	mutable std::mutex _mutex;
+	std::vector<Pending> _pending;
+	// the device whose samples are sent first the next time the line has room
+	std::size_t _turn = 0;
+	// the number of bytes the line can take right away, negative if it is still busy with the frames sent so far
+	double _budget;
+	bool _started = false;
+	std::chrono::steady_clock::time_point _refilled;
+	std::chrono::steady_clock::time_point _first_sample;
+	std::chrono::steady_clock::time_point _last_sample;
+	uint64_t _bytes = 0;
+};
+
+#endif /* SERIALCOALESCER_H_ */
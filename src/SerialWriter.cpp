@@ -0,0 +1,95 @@
+/*
+ * SerialWriter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "SerialWriter.h"
+
+#include <cctype>
+#include <cerrno>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+
+SerialMode SerialMode::parse(const std::string &mode) {
+	SerialMode result;
+	char parity = (mode.size() == 3) ? std::toupper(static_cast<unsigned char>(mode[1])) : '\0';
+	if(mode.size() != 3 || mode[0] < '5' || mode[0] > '8' || (parity != 'N' && parity != 'E' && parity != 'O') || (mode[2] != '1' && mode[2] != '2')) {
+		throw std::invalid_argument("invalid serial mode '" + mode + "' (should be e.g. 8N1)");
+	}
+	result.data_bits = mode[0] - '0';
+	result.parity = parity;
+	result.stop_bits = mode[2] - '0';
+	return result;
+}
+
+SerialWriter::SerialWriter(int fd, std::chrono::milliseconds max_stall) :
+				_fd(fd),
+				_max_stall(max_stall) {
+
+}
+
+bool SerialWriter::write(std::string_view frame) {
+	_queued += frame.size();
+
+	if(_resync) {
+		// terminate the truncated frame, so that the receiver discards it rather than merging it with this one
+		_resync = _send("\n") > 0;
+	}
+
+	std::size_t left = (_resync) ? frame.size() : _send(frame);
+	if(left == 0) {
+		return true;
+	}
+
+	_dropped += left;
+	if(left == frame.size()) {
+		_dropped_frames++;
+	}
+	else {
+		_truncated_frames++;
+		_resync = true;
+	}
+	return false;
+}
+
+std::size_t SerialWriter::_send(std::string_view data) {
+	const char *next = data.data();
+	std::size_t left = data.size();
+	while(left > 0 && !_failed) {
+		ssize_t n = ::write(_fd, next, left);
+		_n_writes++;
+		if(n > 0) {
+			next += n;
+			left -= n;
+			_sent += n;
+			continue;
+		}
+
+		if(n < 0 && errno == EINTR) {
+			continue;
+		}
+		if(n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+			_failed = true;
+			break;
+		}
+
+		// the output buffer of the port is full, wait for it to drain
+		struct pollfd pfd = {_fd, POLLOUT, 0};
+		int ready;
+		do {
+			ready = ::poll(&pfd, 1, static_cast<int>(_max_stall.count()));
+		} while(ready < 0 && errno == EINTR);
+
+		if(ready == 0) {
+			// the port has stalled (e.g. hardware flow control is holding it), give up on this frame only
+			break;
+		}
+		if(ready < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+			_failed = true;
+		}
+	}
+	return left;
+}
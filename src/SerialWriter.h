@@ -0,0 +1,127 @@
+/*
+ * SerialWriter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef SERIALWRITER_H_
+#define SERIALWRITER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * The framing of the characters sent over a serial line, given as e.g. 8N1: data bits (5 to 8), parity (N, E or O)
+ * and stop bits (1 or 2).
+ */
+struct SerialMode {
+	unsigned int data_bits = 8;
+	/// N, E or O
+	char parity = 'N';
+	unsigned int stop_bits = 1;
+
+	/**
+	 * Throws std::invalid_argument if the mode is not valid.
+	 */
+	static SerialMode parse(const std::string &mode);
+
+	/**
+	 * Return the number of bits it takes to send a character, including the start bit.
+	 */
+	unsigned int bits_per_character() const {
+		return 1 + data_bits + ((parity == 'N') ? 0 : 1) + stop_bits;
+	}
+};
+
+/**
+ * Writes frames to a non-blocking file descriptor, such as a serial port opened by RS232_OpenComport. Each frame is
+ * handed to write(2) as a whole: partial writes are resumed and, when the output buffer of the port is full, the
+ * writer waits with poll(2) for it to drain instead of discarding bytes. Frames are meant to be written by a single
+ * thread.
+ */
+class SerialWriter {
+public:
+	/**
+	 * @param fd the file descriptor the frames are written to. It is not closed by the writer
+	 * @param max_stall the longest time the writer waits for the port to accept more bytes: if the port makes no
+	 * progress for this long, the rest of the frame is dropped and the next frame is preceded by a newline
+	 */
+	SerialWriter(int fd, std::chrono::milliseconds max_stall=std::chrono::milliseconds(1000));
+
+	/**
+	 * Write a frame, waiting for the port if needed.
+	 *
+	 * @return false if (some of) the frame has been dropped
+	 */
+	bool write(std::string_view frame);
+
+	/**
+	 * Return the number of bytes handed to the writer.
+	 */
+	uint64_t queued() const {
+		return _queued;
+	}
+
+	/**
+	 * Return the number of bytes accepted by the port.
+	 */
+	uint64_t sent() const {
+		return _sent;
+	}
+
+	/**
+	 * Return the number of bytes dropped because the port stalled or failed.
+	 */
+	uint64_t dropped() const {
+		return _dropped;
+	}
+
+	/**
+	 * Return the number of frames that have been dropped in full.
+	 */
+	uint64_t dropped_frames() const {
+		return _dropped_frames;
+	}
+
+	/**
+	 * Return the number of frames of which only a part could be sent.
+	 */
+	uint64_t truncated_frames() const {
+		return _truncated_frames;
+	}
+
+	/**
+	 * Return the number of write(2) calls issued so far.
+	 */
+	uint64_t n_writes() const {
+		return _n_writes;
+	}
+
+private:
+	/**
+	 * Write the data, waiting for the port if needed.
+	 *
+	 * @return the number of bytes that could not be written
+	 */
+	std::size_t _send(std::string_view data);
+
+	int _fd;
+	std::chrono::milliseconds _max_stall;
+	// set when the port has failed, after which all the frames are dropped
+	bool _failed = false;
+	// set when a frame has been truncated, so that a newline is sent before the next one
+	bool _resync = false;
+
+	uint64_t _queued = 0;
+	uint64_t _sent = 0;
+	uint64_t _dropped = 0;
+	uint64_t _dropped_frames = 0;
+	uint64_t _truncated_frames = 0;
+	uint64_t _n_writes = 0;
+};
+
+#endif /* SERIALWRITER_H_ */
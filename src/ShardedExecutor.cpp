@@ -0,0 +1,65 @@
+/*
+ * ShardedExecutor.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "ShardedExecutor.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+ShardedExecutor::ShardedExecutor(unsigned int n_shards, bool pin_threads) :
+				_pin_threads(pin_threads) {
+	if(n_shards == 0) {
+		n_shards = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	for(unsigned int i = 0; i < n_shards; i++) {
+		// each shard is run by exactly one thread
+		_shards.emplace_back(new asio::io_context(1));
+	}
+}
+
+ShardedExecutor::~ShardedExecutor() {
+
+}
+
+void ShardedExecutor::run() {
+	std::vector<std::thread> threads;
+	unsigned int n_cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for(unsigned int i = 0; i < _shards.size(); i++) {
+		threads.emplace_back([this, i]() {
+			_shards[i]->run();
+		});
+
+		if(_pin_threads) {
+#ifdef __linux__
+			cpu_set_t cpuset;
+			CPU_ZERO(&cpuset);
+			CPU_SET(i % n_cores, &cpuset);
+			int res = pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpu_set_t), &cpuset);
+			if(res != 0) {
+				std::cerr << "WARNING: could not pin shard " << i << " to core " << i % n_cores << std::endl;
+			}
+#else
+			std::cerr << "WARNING: thread pinning is supported only on Linux" << std::endl;
+#endif
+		}
+	}
+
+	for(auto &thread : threads) {
+		thread.join();
+	}
+}
+
+void ShardedExecutor::stop() {
+	for(auto &shard : _shards) {
+		shard->stop();
+	}
+}
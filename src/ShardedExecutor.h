@@ -0,0 +1,65 @@
+/*
+ * ShardedExecutor.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef SHARDEDEXECUTOR_H_
+#define SHARDEDEXECUTOR_H_
+
+#include <asio.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * A pool of independent io_contexts ("shards"), each run by its own thread. Work that belongs to the same shard is
+ * never executed concurrently, so objects bound to a single shard (e.g. the TCPClient of a device) need no locking.
+ */
+class ShardedExecutor {
+public:
+	/**
+	 * @param n_shards the number of shards. If 0, one shard per available core is created
+	 * @param pin_threads if true, the thread running the i-th shard is pinned to the i-th core (Linux only)
+	 */
+	ShardedExecutor(unsigned int n_shards, bool pin_threads=false);
+	ShardedExecutor(const ShardedExecutor &) = delete;
+	virtual ~ShardedExecutor();
+
+	unsigned int size() const {
+		return _shards.size();
+	}
+
+	/**
+	 * Return the shard with the given index.
+	 */
+	asio::io_context &shard(unsigned int idx) {
+		return *_shards[idx % _shards.size()];
+	}
+
+	/**
+	 * Return the shard to be used for the next session. Sessions are spread across shards in a round-robin fashion.
+	 */
+	asio::io_context &next_shard() {
+		return shard(_next++);
+	}
+
+	/**
+	 * Run all the shards and block until all of them have run out of work or stop() has been called.
+	 */
+	void run();
+
+	/**
+	 * Stop all the shards. Can be called from any thread.
+	 */
+	void stop();
+
+private:
+	std::vector<std::unique_ptr<asio::io_context>> _shards;
+	bool _pin_threads;
+	unsigned int _next = 0;
+};
+
+#endif /* SHARDEDEXECUTOR_H_ */
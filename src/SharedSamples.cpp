@@ -0,0 +1,122 @@
+/*
+ * SharedSamples.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "SharedSamples.h"
+
+#include <new>
+
+namespace {
+
+std::size_t round_up(std::size_t value, std::size_t multiple) {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+std::string object_name(const std::string &name) {
+	return (name.size() > 0 && name[0] == '/') ? name : "/" + name;
+}
+
+}
+
+SharedSamplesWriter::SharedSamplesWriter(const std::string &name, std::size_t n_devices, uint64_t history, uint32_t max_channels) :
+				_name(object_name(name)) {
+	if(history == 0) {
+		throw bad_shared_samples("the history should contain at least one sample");
+	}
+
+	// slots and devices are aligned to the size of a cache line, so that devices written by different threads never
+	// share one
+	std::size_t values_offset = round_up(2 * max_channels, 8);
+	std::size_t slot_size = round_up(sizeof(SharedSlot) + values_offset + 8 * max_channels, 64);
+	std::size_t slots_offset = round_up(sizeof(SharedDevice), 64);
+	std::size_t device_size = slots_offset + history * slot_size;
+	std::size_t devices_offset = round_up(sizeof(SharedSamplesHeader), 64);
+	_size = devices_offset + n_devices * device_size;
+
+	int fd = shm_open(_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		throw bad_shared_samples("cannot open '" + name + "': " + std::strerror(errno));
+	}
+	if(ftruncate(fd, _size) != 0) {
+		close(fd);
+		shm_unlink(_name.c_str());
+		throw bad_shared_samples("cannot resize '" + name + "': " + std::strerror(errno));
+	}
+
+	_memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(_memory == MAP_FAILED) {
+		_memory = nullptr;
+		shm_unlink(_name.c_str());
+		throw bad_shared_samples("cannot map '" + name + "': " + std::strerror(errno));
+	}
+
+	// the object has just been truncated, so all the counts and markers are zero
+	_header = new (_memory) SharedSamplesHeader;
+	_header->version = SHARED_SAMPLES_VERSION;
+	_header->max_channels = max_channels;
+	_header->n_devices = n_devices;
+	_header->history = history;
+	_header->slot_size = slot_size;
+	_header->device_size = device_size;
+	_header->devices_offset = devices_offset;
+	_header->closed.store(0, std::memory_order_relaxed);
+	for(std::size_t i = 0; i < n_devices; i++) {
+		new (static_cast<char*>(_memory) + devices_offset + i * device_size) SharedDevice;
+	}
+
+	// readers recognise the object only once the magic has been written
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(_header->magic, SHARED_SAMPLES_MAGIC, sizeof(SHARED_SAMPLES_MAGIC));
+}
+
+SharedSamplesWriter::~SharedSamplesWriter() {
+	if(_memory != nullptr) {
+		_header->closed.store(1, std::memory_order_release);
+		munmap(_memory, _size);
+		shm_unlink(_name.c_str());
+	}
+}
+
+void SharedSamplesWriter::write(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty, std::chrono::system_clock::time_point time) {
+	char *base = static_cast<char*>(_memory) + _header->devices_offset + slot * _header->device_size;
+	auto *device = reinterpret_cast<SharedDevice*>(base);
+	// only the thread that publishes the samples of the device touches its count, hence it can be read relaxed
+	uint64_t index = device->count.load(std::memory_order_relaxed);
+	if(index == 0) {
+		// the tag is published together with the first sample
+		device->device_id = device_id;
+		std::size_t length = std::min(tag.size(), SHARED_TAG_SIZE - 1);
+		std::memcpy(device->tag, tag.data(), length);
+		device->tag[length] = '\0';
+	}
+
+	std::size_t n_values = values.size();
+	if(n_values > _header->max_channels) {
+		n_values = _header->max_channels;
+		_truncated.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	char *raw = base + round_up(sizeof(SharedDevice), 64) + (index % _header->history) * _header->slot_size;
+	auto *shared = reinterpret_cast<SharedSlot*>(raw);
+	shared->marker.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	shared->delta_time = delta_time;
+	shared->epoch_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	shared->uncertainty = uncertainty;
+	shared->n_values = n_values;
+	uint8_t *specs = reinterpret_cast<uint8_t*>(shared + 1);
+	char *readings = raw + sizeof(SharedSlot) + round_up(2 * _header->max_channels, 8);
+	for(std::size_t i = 0; i < n_values; i++) {
+		specs[2 * i] = static_cast<uint8_t>(schema[i].type);
+		specs[2 * i + 1] = static_cast<uint8_t>(schema[i].decimals);
+	}
+	std::memcpy(readings, values.data(), n_values * sizeof(ChannelValue));
+
+	shared->marker.store(2 * index + 2, std::memory_order_release);
+	device->count.store(index + 1, std::memory_order_release);
+}
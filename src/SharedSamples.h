@@ -0,0 +1,315 @@
+/*
+ * SharedSamples.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef SHAREDSAMPLES_H_
+#define SHAREDSAMPLES_H_
+
+#include "channels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * The latest samples of each device, published in a POSIX shared-memory object. The object starts with a
+ * SharedSamplesHeader, followed by one region per device. Each region starts with a SharedDevice, followed by a ring
+ * of history slots, each made of a SharedSlot, the specs of the readings (two bytes per channel: type and number of
+ * decimal digits) and the readings (eight bytes per channel, see ChannelValue).
+ *
+ * Each device is written by a single thread. Sample i of a device is stored in the slot i % history, whose marker is
+ * set to 2i + 1 while the sample is being written and to 2i + 2 once it is complete, after which the count of the
+ * device is set to i + 1. A reader copies the slot and checks that the marker is the same before and after the copy:
+ * readers never take locks nor make system calls, and the writer never waits for them.
+ *
+ * The reader below only depends on this header and on channels.h, so that it can be dropped into other programs.
+ */
+
+constexpr char SHARED_SAMPLES_MAGIC[8] = {'P', 'A', 'D', 'L', 'S', 'H', 'M', '\0'};
+constexpr uint32_t SHARED_SAMPLES_VERSION = 1;
+/// the size of the tag of each device, including the terminating null character
+constexpr std::size_t SHARED_TAG_SIZE = 64;
+
+struct SharedSamplesHeader {
+	char magic[8];
+	uint32_t version;
+	/// the maximum number of readings per sample, further readings are not published
+	uint32_t max_channels;
+	uint64_t n_devices;
+	/// the number of samples kept for each device
+	uint64_t history;
+	/// the size of each slot, including its SharedSlot header
+	uint64_t slot_size;
+	/// the size of the region of each device, including its SharedDevice header
+	uint64_t device_size;
+	/// the offset of the first device from the beginning of the object
+	uint64_t devices_offset;
+	/// set to 1 when the writer goes away
+	std::atomic<uint32_t> closed;
+};
+
+struct SharedDevice {
+	/// the number of samples published so far
+	alignas(64) std::atomic<uint64_t> count;
+	/// the id printed in front of the samples, or -1
+	int32_t device_id;
+	/// the tag of the device, null-terminated
+	char tag[SHARED_TAG_SIZE];
+};
+
+struct SharedSlot {
+	std::atomic<uint64_t> marker;
+	uint64_t delta_time;
+	int64_t epoch_ns;
+	/// the timing uncertainty, or -1 if it is not available
+	int64_t uncertainty;
+	uint32_t n_values;
+	uint32_t reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared samples require lock-free 64-bit atomics");
+
+class bad_shared_samples: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * A sample copied out of the shared-memory object.
+ */
+struct SharedSample {
+	/// the number of samples published by the device before this one
+	uint64_t index = 0;
+	uint64_t delta_time = 0;
+	/// the time at which the sample was received, in nanoseconds since the Unix epoch
+	int64_t epoch_ns = 0;
+	int64_t uncertainty = -1;
+	std::vector<ChannelSpec> specs;
+	std::vector<ChannelValue> values;
+};
+
+/**
+ * Publishes the samples of a fixed number of devices.
+ */
+class SharedSamplesWriter {
+public:
+	/**
+	 * Create (or truncate) the shared-memory object and map it. Throws bad_shared_samples on error.
+	 *
+	 * @param name the name of the object (e.g. padl, which on Linux shows up as /dev/shm/padl)
+	 * @param n_devices
+	 * @param history the number of samples kept for each device
+	 * @param max_channels the maximum number of readings per sample
+	 */
+	SharedSamplesWriter(const std::string &name, std::size_t n_devices, uint64_t history=64, uint32_t max_channels=64);
+	SharedSamplesWriter(const SharedSamplesWriter &) = delete;
+
+	/**
+	 * Mark the object as closed, unmap it and remove its name, so that new readers cannot mistake stale samples for
+	 * fresh ones. Readers that have already mapped the object can still read it.
+	 */
+	virtual ~SharedSamplesWriter();
+
+	/**
+	 * Publish a sample. Samples of different devices can be published concurrently, but the samples of each device
+	 * should always be published by the same thread.
+	 */
+	void write(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty, std::chrono::system_clock::time_point time);
+
+	/**
+	 * Return the number of samples whose readings did not all fit in a slot.
+	 */
+	uint64_t truncated() const {
+		return _truncated.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::string _name;
+	void *_memory = nullptr;
+	std::size_t _size = 0;
+	SharedSamplesHeader *_header = nullptr;
+	std::atomic<uint64_t> _truncated{0};
+};
+
+/**
+ * Reads the samples published by a SharedSamplesWriter, possibly from another process.
+ */
+class SharedSamplesReader {
+public:
+	/**
+	 * Map an existing shared-memory object. Throws bad_shared_samples on error.
+	 */
+	SharedSamplesReader(const std::string &name) {
+		std::string object = (name.size() > 0 && name[0] == '/') ? name : "/" + name;
+		int fd = shm_open(object.c_str(), O_RDONLY, 0);
+		if(fd < 0) {
+			throw bad_shared_samples("cannot open '" + name + "': " + std::strerror(errno));
+		}
+
+		struct stat st;
+		if(fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(SharedSamplesHeader)) {
+			close(fd);
+			throw bad_shared_samples("'" + name + "' does not contain shared samples");
+		}
+		_size = st.st_size;
+
+		_memory = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if(_memory == MAP_FAILED) {
+			_memory = nullptr;
+			throw bad_shared_samples("cannot map '" + name + "': " + std::strerror(errno));
+		}
+
+		_header = static_cast<const SharedSamplesHeader*>(_memory);
+		bool valid = std::memcmp(_header->magic, SHARED_SAMPLES_MAGIC, sizeof(SHARED_SAMPLES_MAGIC)) == 0 && _header->version == SHARED_SAMPLES_VERSION;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(!valid || _header->history == 0 || _header->devices_offset + _header->n_devices * _header->device_size > _size || _header->slot_size < sizeof(SharedSlot) + _values_offset() + 8 * _header->max_channels) {
+			munmap(_memory, _size);
+			_memory = nullptr;
+			throw bad_shared_samples("'" + name + "' does not contain shared samples");
+		}
+		_copy.resize(_header->slot_size);
+	}
+
+	SharedSamplesReader(const SharedSamplesReader &) = delete;
+
+	virtual ~SharedSamplesReader() {
+		if(_memory != nullptr) {
+			munmap(_memory, _size);
+		}
+	}
+
+	std::size_t n_devices() const {
+		return _header->n_devices;
+	}
+
+	uint64_t history() const {
+		return _header->history;
+	}
+
+	/**
+	 * Return true if the writer has gone away, in which case no new samples will be published.
+	 */
+	bool closed() const {
+		return _header->closed.load(std::memory_order_acquire) != 0;
+	}
+
+	/**
+	 * Return the number of samples published so far by the given device.
+	 */
+	uint64_t count(std::size_t device) const {
+		return _device(device)->count.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Return the tag of the given device, which is empty if the device has not published any sample yet.
+	 */
+	std::string tag(std::size_t device) const {
+		if(count(device) == 0) {
+			return std::string();
+		}
+		const char *tag = _device(device)->tag;
+		return std::string(tag, strnlen(tag, SHARED_TAG_SIZE));
+	}
+
+	/**
+	 * Return the id of the given device, or -1 if it should not be printed.
+	 */
+	int device_id(std::size_t device) const {
+		return (count(device) > 0) ? _device(device)->device_id : -1;
+	}
+
+	/**
+	 * Copy the latest sample of the given device.
+	 *
+	 * @return false if the device has not published any sample yet
+	 */
+	bool latest(std::size_t device, SharedSample &sample) {
+		while(true) {
+			uint64_t n = count(device);
+			if(n == 0) {
+				return false;
+			}
+			if(get(device, n - 1, sample)) {
+				return true;
+			}
+			// the writer has gone all the way around the history while we were copying, try again
+		}
+	}
+
+	/**
+	 * Copy the sample with the given index.
+	 *
+	 * @return false if the sample has not been published yet or has already been overwritten
+	 */
+	bool get(std::size_t device, uint64_t index, SharedSample &sample) {
+		const char *slot = reinterpret_cast<const char*>(_device(device)) + _slots_offset() + (index % _header->history) * _header->slot_size;
+		const auto *shared = reinterpret_cast<const SharedSlot*>(slot);
+		uint64_t complete = 2 * index + 2;
+
+		if(shared->marker.load(std::memory_order_acquire) != complete) {
+			return false;
+		}
+		std::memcpy(_copy.data() + sizeof(shared->marker), slot + sizeof(shared->marker), _header->slot_size - sizeof(shared->marker));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(shared->marker.load(std::memory_order_relaxed) != complete) {
+			return false;
+		}
+
+		// the copy is consistent, and can be decoded at leisure
+		const auto *copy = reinterpret_cast<const SharedSlot*>(_copy.data());
+		uint32_t n_values = std::min(copy->n_values, _header->max_channels);
+		sample.index = index;
+		sample.delta_time = copy->delta_time;
+		sample.epoch_ns = copy->epoch_ns;
+		sample.uncertainty = copy->uncertainty;
+		sample.specs.resize(n_values);
+		sample.values.resize(n_values);
+		const uint8_t *specs = reinterpret_cast<const uint8_t*>(copy + 1);
+		const char *values = _copy.data() + sizeof(SharedSlot) + _values_offset();
+		for(uint32_t i = 0; i < n_values; i++) {
+			sample.specs[i].type = static_cast<ChannelType>(specs[2 * i]);
+			sample.specs[i].decimals = specs[2 * i + 1];
+			std::memcpy(&sample.values[i], values + 8 * i, sizeof(ChannelValue));
+		}
+
+		return true;
+	}
+
+private:
+	const SharedDevice *_device(std::size_t device) const {
+		return reinterpret_cast<const SharedDevice*>(static_cast<const char*>(_memory) + _header->devices_offset + device * _header->device_size);
+	}
+
+	static std::size_t _slots_offset() {
+		return (sizeof(SharedDevice) + 63) / 64 * 64;
+	}
+
+	/**
+	 * The offset of the readings from the end of the SharedSlot.
+	 */
+	std::size_t _values_offset() const {
+		return (2 * _header->max_channels + 7) / 8 * 8;
+	}
+
+	void *_memory = nullptr;
+	std::size_t _size = 0;
+	const SharedSamplesHeader *_header = nullptr;
+	// where the slots are copied before being decoded
+	std::vector<char> _copy;
+};
+
+#endif /* SHAREDSAMPLES_H_ */
@@ -0,0 +1,550 @@
+/*
+ * Sinks.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "Sinks.h"
+
+#include "strings.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// how long a sink thread keeps waiting for new samples before asking to be woken up by the producers
+constexpr std::chrono::milliseconds SINK_LINGER(1);
+
+const char *sink_kinds[] = {"stdout", "serial", "file", "tcp", "ring", "record", "shm"};
+
+bool needs_target(const std::string &kind) {
+	return kind == "file" || kind == "tcp" || kind == "ring" || kind == "record" || kind == "shm";
+}
+
+template<typename T>
+T parse_positive(const std::string &description, const std::string &key, const std::string &value) {
+	T result;
+	if(utils::try_parse(value, result) != utils::ParseStatus::OK || result == 0) {
+		throw std::invalid_argument("invalid " + key + " '" + value + "' in sink '" + description + "', it should be a positive integer");
+	}
+	return result;
+}
+
+}
+
+void append_text_line(std::string &out, const Sample &sample, const TimeFormatter &formatter) {
+	if(sample.device_id >= 0) {
+		out += *sample.tag;
+		out += ' ';
+	}
+	utils::append_number(out, sample.delta_time);
+	out += ' ';
+	if(sample.uncertainty >= 0) {
+		utils::append_number(out, sample.uncertainty);
+		out += ' ';
+	}
+	formatter.append(out, sample.time, sample.steady_time);
+	append_readings(out, sample.values, *sample.schema);
+}
+
+SinkSpec SinkSpec::parse(const std::string &description) {
+	auto options = utils::split(description, ",");
+	if(options.empty()) {
+		throw std::invalid_argument("empty sink description");
+	}
+
+	SinkSpec spec;
+	auto colon = options[0].find(':');
+	spec.kind = options[0].substr(0, colon);
+	if(colon != std::string::npos) {
+		spec.target = options[0].substr(colon + 1);
+	}
+	// a slow serial line or network should not hold back the polling, while files and pipes should not lose samples
+	if(spec.kind == "serial" || spec.kind == "tcp") {
+		spec.overflow = SinkOverflow::DROP;
+	}
+
+	if(std::find(std::begin(sink_kinds), std::end(sink_kinds), spec.kind) == std::end(sink_kinds)) {
+		throw std::invalid_argument("unknown sink '" + spec.kind + "' (should be stdout, serial, file, tcp, ring, record or shm)");
+	}
+	if(needs_target(spec.kind) && spec.target.empty()) {
+		throw std::invalid_argument("the " + spec.kind + " sink should be given as " + spec.kind + ((spec.kind == "tcp") ? ":HOST:PORT" : ":PATH"));
+	}
+	if(!needs_target(spec.kind) && !spec.target.empty()) {
+		throw std::invalid_argument("the " + spec.kind + " sink does not take a target");
+	}
+
+	for(std::size_t i = 1; i < options.size(); i++) {
+		auto eq = options[i].find('=');
+		std::string key = options[i].substr(0, eq);
+		std::string value = (eq != std::string::npos) ? options[i].substr(eq + 1) : "";
+		if(key == "every") {
+			spec.every = parse_positive<unsigned int>(description, key, value);
+		}
+		else if(key == "queue") {
+			spec.queue = parse_positive<std::size_t>(description, key, value);
+		}
+		else if(key == "format") {
+			if(value != "text" && value != "binary") {
+				throw std::invalid_argument("invalid format '" + value + "' in sink '" + description + "' (should be text or binary)");
+			}
+			if(spec.kind != "stdout" && spec.kind != "file" && spec.kind != "tcp") {
+				throw std::invalid_argument("the format of the " + spec.kind + " sink cannot be changed");
+			}
+			spec.format = value;
+		}
+		else if(key == "overflow") {
+			if(value == "block") {
+				spec.overflow = SinkOverflow::BLOCK;
+			}
+			else if(value == "drop") {
+				spec.overflow = SinkOverflow::DROP;
+			}
+			else {
+				throw std::invalid_argument("invalid overflow '" + value + "' in sink '" + description + "' (should be block or drop)");
+			}
+			if(spec.kind == "shm") {
+				throw std::invalid_argument("the shm sink has no queue, hence it has no overflow policy");
+			}
+		}
+		else {
+			throw std::invalid_argument("unknown option '" + key + "' in sink '" + description + "' (should be every, format, queue or overflow)");
+		}
+	}
+
+	return spec;
+}
+
+StreamSink::StreamSink(const std::string &name, int fd, bool owns_fd, bool binary, std::size_t n_devices, const TimeFormatter &formatter, std::chrono::milliseconds max_latency) :
+				Sink(name),
+				_fd(fd),
+				_owns_fd(owns_fd),
+				_formatter(formatter),
+				_output(new OutputWriter(fd, max_latency)) {
+	if(binary) {
+		_binary.reset(new BinaryWriter(*_output, n_devices));
+	}
+}
+
+StreamSink::~StreamSink() {
+	close();
+}
+
+void StreamSink::write(const Sample &sample) {
+	if(_binary) {
+		_binary->write(sample.slot, sample.device_id, *sample.tag, sample.values, *sample.schema, sample.delta_time, sample.uncertainty, sample.time);
+		return;
+	}
+
+	_line.clear();
+	append_text_line(_line, sample, _formatter);
+	_line += '\n';
+	_output->append(_line);
+}
+
+void StreamSink::close() {
+	if(!_output) {
+		return;
+	}
+
+	// the writer flushes what is left in its buffer on destruction
+	_binary.reset();
+	_output.reset();
+	if(_owns_fd) {
+		::close(_fd);
+	}
+}
+
+RingSink::RingSink(const std::string &path, uint64_t n_slots, const TimeFormatter &formatter) :
+				Sink("ring " + path),
+				_ring(path, n_slots),
+				_formatter(formatter) {
+
+}
+
+void RingSink::write(const Sample &sample) {
+	_line.clear();
+	append_text_line(_line, sample, _formatter);
+	_ring.append(_line);
+}
+
+void RingSink::print_stats(std::ostream &out) const {
+	if(_ring.truncated() > 0) {
+		out << "WARNING: " << _ring.truncated() << " lines did not fit in the slots of the ring log and have been truncated" << std::endl;
+	}
+}
+
+RecordSink::RecordSink(const std::string &path, std::size_t n_devices) :
+				Sink("record " + path),
+				_recorder(path, n_devices) {
+
+}
+
+void RecordSink::write(const Sample &sample) {
+	_recorder.write(sample.slot, sample.device_id, *sample.tag, sample.values, *sample.schema, sample.delta_time, sample.uncertainty, sample.time);
+}
+
+void RecordSink::close() {
+	_recorder.close();
+}
+
+void RecordSink::print_stats(std::ostream &out) const {
+	out << "Recorded " << _recorder.samples() << " samples in " << _recorder.bytes() << " bytes" << std::endl;
+	std::string error = _recorder.error();
+	if(!error.empty()) {
+		out << "ERROR: " << error << ", " << _recorder.lost_samples() << " samples have not been recorded" << std::endl;
+	}
+}
+
+SharedSamplesSink::SharedSamplesSink(const std::string &name, std::size_t n_devices, uint64_t history) :
+				Sink("shm " + name),
+				_writer(name, n_devices, history) {
+
+}
+
+void SharedSamplesSink::write(const Sample &sample) {
+	_writer.write(sample.slot, sample.device_id, *sample.tag, sample.values, *sample.schema, sample.delta_time, sample.uncertainty, sample.time);
+}
+
+void SharedSamplesSink::print_stats(std::ostream &out) const {
+	if(_writer.truncated() > 0) {
+		out << "WARNING: " << _writer.truncated() << " samples had too many channels to be published in full" << std::endl;
+	}
+}
+
+int open_sink_file(const std::string &path) {
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		throw bad_sink("cannot open '" + path + "': " + std::strerror(errno));
+	}
+	return fd;
+}
+
+int connect_sink_socket(const std::string &address) {
+	auto colon = address.rfind(':');
+	if(colon == std::string::npos) {
+		throw bad_sink("the address '" + address + "' should be given as host:port");
+	}
+	std::string host = address.substr(0, colon);
+	std::string port = address.substr(colon + 1);
+
+	addrinfo hints{};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo *results;
+	int ret = getaddrinfo(host.c_str(), port.c_str(), &hints, &results);
+	if(ret != 0) {
+		throw bad_sink("cannot resolve '" + address + "': " + gai_strerror(ret));
+	}
+
+	int fd = -1;
+	int error = 0;
+	for(addrinfo *info = results; info != nullptr; info = info->ai_next) {
+		fd = ::socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+		if(fd < 0) {
+			error = errno;
+			continue;
+		}
+		if(::connect(fd, info->ai_addr, info->ai_addrlen) == 0) {
+			break;
+		}
+		error = errno;
+		::close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(results);
+
+	if(fd < 0) {
+		throw bad_sink("cannot connect to '" + address + "': " + std::strerror(error));
+	}
+	return fd;
+}
+
+/**
+ * A sink, its queue and the thread that empties it. Direct sinks have neither.
+ */
+struct SinkFanOut::SinkThread {
+	std::unique_ptr<Sink> sink;
+	unsigned int every;
+	bool direct = false;
+	bool block = true;
+	// the number of samples offered by each device and, for direct sinks, written to the sink. Each element is touched
+	// only by the thread that polls the device
+	std::vector<uint64_t> offered;
+	std::vector<uint64_t> written_directly;
+
+	// protects the indices of the queue, the flags and the counters below
+	std::mutex mutex;
+	std::condition_variable cv;
+	// signalled when a blocked producer can queue its sample
+	std::condition_variable space;
+	// a ring of samples whose buffers are reused, so that queueing a sample does not allocate memory. head and tail
+	// count the samples pushed and popped since the start, the ones in [tail, head) are waiting to be written
+	std::vector<Sample> queue;
+	uint64_t head = 0;
+	uint64_t tail = 0;
+	bool waiting = false;
+	bool stop = false;
+	uint64_t dropped = 0;
+	uint64_t written = 0;
+	// the number of producers waiting for a free slot, and how many times they had to
+	unsigned int blocked = 0;
+	uint64_t stalls = 0;
+
+	std::thread thread;
+
+	/**
+	 * Make sure that the queue has room for one more sample, waiting for it if the sink blocks. Otherwise, count the
+	 * sample as dropped and return false.
+	 */
+	bool make_room(std::unique_lock<std::mutex> &lock) {
+		if(head - tail < queue.size()) {
+			return true;
+		}
+		if(!block) {
+			dropped++;
+			return false;
+		}
+
+		stalls++;
+		blocked++;
+		// the thread may be lingering, there is no point in waiting for it to time out
+		cv.notify_one();
+		space.wait(lock, [this]() {
+			return head - tail < queue.size();
+		});
+		blocked--;
+		return true;
+	}
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while(true) {
+			if(head == tail && !stop) {
+				// when samples are flowing, the queue is polled so that the producers do not have to wake this thread
+				// up for each sample, which would cost them a system call every time
+				cv.wait_for(lock, SINK_LINGER);
+			}
+			while(head == tail && !stop) {
+				waiting = true;
+				cv.wait(lock);
+				waiting = false;
+			}
+			if(head == tail) {
+				return;
+			}
+
+			// the samples are written without holding the lock: the producers do not touch the slots in [tail, head)
+			uint64_t begin = tail, end = head;
+			lock.unlock();
+			for(uint64_t i = begin; i < end; i++) {
+				sink->write(queue[i % queue.size()]);
+			}
+			lock.lock();
+			tail = end;
+			written += end - begin;
+			if(blocked > 0) {
+				space.notify_all();
+			}
+		}
+	}
+};
+
+SinkFanOut::SinkFanOut(std::size_t n_devices) :
+				_n_devices(n_devices) {
+
+}
+
+SinkFanOut::~SinkFanOut() {
+	stop();
+}
+
+void SinkFanOut::add(std::unique_ptr<Sink> sink, unsigned int every, std::size_t queue_size, SinkOverflow overflow) {
+	std::unique_ptr<SinkThread> sink_thread(new SinkThread());
+	sink_thread->sink = std::move(sink);
+	sink_thread->every = std::max(every, 1u);
+	sink_thread->block = overflow == SinkOverflow::BLOCK;
+	sink_thread->offered.resize(_n_devices, 0);
+	sink_thread->queue.resize(std::max<std::size_t>(queue_size, 1));
+
+	SinkThread *raw = sink_thread.get();
+	sink_thread->thread = std::thread([raw]() {
+		raw->run();
+	});
+	_sinks.push_back(std::move(sink_thread));
+}
+
+void SinkFanOut::add_direct(std::unique_ptr<Sink> sink, unsigned int every) {
+	std::unique_ptr<SinkThread> sink_thread(new SinkThread());
+	sink_thread->sink = std::move(sink);
+	sink_thread->every = std::max(every, 1u);
+	sink_thread->direct = true;
+	sink_thread->offered.resize(_n_devices, 0);
+	sink_thread->written_directly.resize(_n_devices, 0);
+	_sinks.push_back(std::move(sink_thread));
+}
+
+void SinkFanOut::publish(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty) {
+	auto time = std::chrono::system_clock::now();
+	auto steady_time = std::chrono::steady_clock::now();
+
+	for(auto &s : _sinks) {
+		if(s->offered[slot]++ % s->every != 0) {
+			continue;
+		}
+
+		if(s->direct) {
+			thread_local Sample sample;
+			sample.slot = slot;
+			sample.device_id = device_id;
+			sample.tag = &tag;
+			sample.schema = &schema;
+			sample.values.assign(values.begin(), values.end());
+			sample.delta_time = delta_time;
+			sample.uncertainty = uncertainty;
+			sample.time = time;
+			sample.steady_time = steady_time;
+			s->sink->write(sample);
+			s->written_directly[slot]++;
+			continue;
+		}
+
+		bool notify;
+		{
+			std::unique_lock<std::mutex> lock(s->mutex);
+			if(!s->make_room(lock)) {
+				continue;
+			}
+
+			Sample &sample = s->queue[s->head % s->queue.size()];
+			sample.slot = slot;
+			sample.device_id = device_id;
+			sample.tag = &tag;
+			sample.schema = &schema;
+			sample.values.assign(values.begin(), values.end());
+			sample.delta_time = delta_time;
+			sample.uncertainty = uncertainty;
+			sample.time = time;
+			sample.steady_time = steady_time;
+			s->head++;
+			// a lingering thread is woken up only if its queue is filling up
+			notify = s->waiting || s->head - s->tail == s->queue.size() / 2;
+		}
+		if(notify) {
+			s->cv.notify_one();
+		}
+	}
+}
+
+void SinkFanOut::publish_block(std::size_t slot, int device_id, const std::string &tag, const SampleBlock &block, const ChannelSchema &schema, int64_t uncertainty) {
+	auto time = std::chrono::system_clock::now();
+	auto steady_time = std::chrono::steady_clock::now();
+
+	// the readings are gathered from the columns of the block straight into the buffers of the sinks
+	auto fill = [&](Sample &sample, std::size_t row) {
+		sample.slot = slot;
+		sample.device_id = device_id;
+		sample.tag = &tag;
+		sample.schema = &schema;
+		block.row(row, sample.values);
+		sample.delta_time = block.timestamps()[row];
+		sample.uncertainty = uncertainty;
+		sample.time = time;
+		sample.steady_time = steady_time;
+	};
+
+	for(auto &s : _sinks) {
+		if(s->direct) {
+			thread_local Sample sample;
+			for(std::size_t row = 0; row < block.size(); row++) {
+				if(s->offered[slot]++ % s->every != 0) {
+					continue;
+				}
+				fill(sample, row);
+				s->sink->write(sample);
+				s->written_directly[slot]++;
+			}
+			continue;
+		}
+
+		// the whole block is queued under a single lock
+		bool notify;
+		{
+			std::unique_lock<std::mutex> lock(s->mutex);
+			uint64_t queued = s->head - s->tail;
+			for(std::size_t row = 0; row < block.size(); row++) {
+				if(s->offered[slot]++ % s->every != 0) {
+					continue;
+				}
+				if(!s->make_room(lock)) {
+					continue;
+				}
+				// the thread may have emptied the queue while this one was waiting
+				queued = std::min(queued, s->head - s->tail);
+				fill(s->queue[s->head % s->queue.size()], row);
+				s->head++;
+			}
+			uint64_t half = s->queue.size() / 2;
+			notify = s->head - s->tail > queued && (s->waiting || (queued < half && s->head - s->tail >= half));
+		}
+		if(notify) {
+			s->cv.notify_one();
+		}
+	}
+}
+
+void SinkFanOut::stop() {
+	if(_stopped) {
+		return;
+	}
+	_stopped = true;
+
+	for(auto &s : _sinks) {
+		if(s->direct) {
+			continue;
+		}
+		{
+			std::lock_guard<std::mutex> lock(s->mutex);
+			s->stop = true;
+		}
+		s->cv.notify_one();
+	}
+	for(auto &s : _sinks) {
+		if(!s->direct) {
+			s->thread.join();
+		}
+		s->sink->close();
+	}
+}
+
+void SinkFanOut::print_stats(std::ostream &out) const {
+	for(auto &s : _sinks) {
+		uint64_t offered = 0;
+		for(auto n : s->offered) {
+			offered += n;
+		}
+		if(s->direct) {
+			uint64_t written = 0;
+			for(auto n : s->written_directly) {
+				written += n;
+			}
+			out << s->sink->name() << ", samples: " << written << ", decimated: " << offered - written << ", dropped: 0" << std::endl;
+			s->sink->print_stats(out);
+			continue;
+		}
+		std::lock_guard<std::mutex> lock(s->mutex);
+		out << s->sink->name() << ", samples: " << s->written << ", decimated: " << offered - s->head - s->dropped << ", dropped: " << s->dropped;
+		if(s->block) {
+			out << ", stalls: " << s->stalls;
+		}
+		out << std::endl;
+		s->sink->print_stats(out);
+	}
+}
@@ -0,0 +1,260 @@
+/*
+ * Sinks.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef SINKS_H_
+#define SINKS_H_
+
+#include "BinaryFormat.h"
+#include "channels.h"
+#include "OutputWriter.h"
+#include "Recording.h"
+#include "RingLog.h"
+#include "Sample.h"
+#include "SampleBlock.h"
+#include "SharedSamples.h"
+#include "TimeFormatter.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class bad_sink: public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * Append the sample to out as a text line (without the trailing newline): [tag] delta_time [uncertainty] current_time
+ * readings.
+ */
+void append_text_line(std::string &out, const Sample &sample, const TimeFormatter &formatter);
+
+/**
+ * What a sink does with the samples that do not fit in its queue.
+ */
+enum class SinkOverflow {
+	/// wait until the sink has written enough samples, which holds back the threads that poll the devices
+	BLOCK,
+	/// drop the samples
+	DROP
+};
+
+/**
+ * The description of a sink given on the command line,
+ * KIND[:TARGET][,every=N][,format=text|binary][,queue=N][,overflow=block|drop].
+ */
+struct SinkSpec {
+	/// stdout, serial, file, tcp, ring, record or shm
+	std::string kind;
+	/// the path of a file or the host:port of a TCP listener
+	std::string target;
+	/// only one sample out of every samples of each device is sent to the sink
+	unsigned int every = 1;
+	/// text or binary, empty if the default format should be used
+	std::string format;
+	/// the maximum number of samples waiting to be written
+	std::size_t queue = 4096;
+	/// what to do when the queue is full, by default only serial and tcp sinks drop samples
+	SinkOverflow overflow = SinkOverflow::BLOCK;
+
+	/**
+	 * Parse a sink description. Throws std::invalid_argument if it is malformed.
+	 */
+	static SinkSpec parse(const std::string &description);
+};
+
+/**
+ * Something samples can be written to. The samples are written by a single thread, owned by the SinkFanOut the sink
+ * belongs to.
+ */
+class Sink {
+public:
+	Sink(const std::string &name) :
+					_name(name) {
+
+	}
+
+	virtual ~Sink() = default;
+
+	virtual void write(const Sample &sample) = 0;
+
+	/**
+	 * Called once after the last sample has been written, from the thread that owns the SinkFanOut.
+	 */
+	virtual void close() {
+
+	}
+
+	/**
+	 * Print the statistics specific to this kind of sink, if any.
+	 */
+	virtual void print_stats(std::ostream &) const {
+
+	}
+
+	const std::string &name() const {
+		return _name;
+	}
+
+private:
+	std::string _name;
+};
+
+/**
+ * Writes the samples as text lines or binary records (see BinaryWriter) to a file descriptor: the standard output, a
+ * file or a socket. The output is batched by an OutputWriter.
+ */
+class StreamSink: public Sink {
+public:
+	/**
+	 * @param name
+	 * @param fd
+	 * @param owns_fd whether fd should be closed by the sink
+	 * @param binary
+	 * @param n_devices
+	 * @param formatter formats the current_time column of the text lines
+	 * @param max_latency see OutputWriter
+	 */
+	StreamSink(const std::string &name, int fd, bool owns_fd, bool binary, std::size_t n_devices, const TimeFormatter &formatter, std::chrono::milliseconds max_latency);
+	virtual ~StreamSink();
+
+	void write(const Sample &sample) override;
+	void close() override;
+
+private:
+	int _fd;
+	bool _owns_fd;
+	TimeFormatter _formatter;
+	std::string _line;
+	std::unique_ptr<OutputWriter> _output;
+	std::unique_ptr<BinaryWriter> _binary;
+};
+
+/**
+ * Writes the samples as text lines to a memory-mapped ring log.
+ */
+class RingSink: public Sink {
+public:
+	RingSink(const std::string &path, uint64_t n_slots, const TimeFormatter &formatter);
+
+	void write(const Sample &sample) override;
+	void print_stats(std::ostream &out) const override;
+
+private:
+	RingLogWriter _ring;
+	TimeFormatter _formatter;
+	std::string _line;
+};
+
+/**
+ * Writes the samples to a columnar recording.
+ */
+class RecordSink: public Sink {
+public:
+	RecordSink(const std::string &path, std::size_t n_devices);
+
+	void write(const Sample &sample) override;
+	void close() override;
+	void print_stats(std::ostream &out) const override;
+
+private:
+	RecordingWriter _recorder;
+};
+
+/**
+ * Publishes the latest samples of each device in shared memory, see SharedSamplesWriter.
+ */
+class SharedSamplesSink: public Sink {
+public:
+	SharedSamplesSink(const std::string &name, std::size_t n_devices, uint64_t history);
+
+	void write(const Sample &sample) override;
+	void print_stats(std::ostream &out) const override;
+
+private:
+	SharedSamplesWriter _writer;
+};
+
+/**
+ * Open (or truncate) a file to be used by a StreamSink. Throws bad_sink on error.
+ */
+int open_sink_file(const std::string &path);
+
+/**
+ * Connect to a TCP listener given as host:port. Throws bad_sink on error.
+ */
+int connect_sink_socket(const std::string &address);
+
+/**
+ * Sends each sample to any number of sinks. Each sink is fed by its own thread through a bounded queue: if a sink
+ * cannot keep up, the samples that do not fit in its queue are dropped, so that a slow sink (e.g. a serial line)
+ * never holds back the polling threads nor the other sinks.
+ */
+class SinkFanOut {
+public:
+	/**
+	 * @param n_devices the number of devices whose samples will be published
+	 */
+	SinkFanOut(std::size_t n_devices);
+	SinkFanOut(const SinkFanOut &) = delete;
+	virtual ~SinkFanOut();
+
+	/**
+	 * Add a sink and start its thread. Sinks should be added before samples are published.
+	 *
+	 * @param sink
+	 * @param every the sink receives only one sample out of every samples of each device
+	 * @param queue_size the maximum number of samples waiting to be written to the sink
+	 * @param overflow what publish() does when the queue is full
+	 */
+	void add(std::unique_ptr<Sink> sink, unsigned int every=1, std::size_t queue_size=4096, SinkOverflow overflow=SinkOverflow::BLOCK);
+
+	/**
+	 * Add a sink that is written directly by the threads that publish the samples, without a queue nor a thread of its
+	 * own. Only sinks that never block and accept the samples of different devices concurrently (e.g. a
+	 * SharedSamplesSink) should be added this way.
+	 */
+	void add_direct(std::unique_ptr<Sink> sink, unsigned int every=1);
+
+	/**
+	 * Send a sample to the sinks. The samples of each device should always be published by the same thread, which
+	 * waits if the queue of a blocking sink is full.
+	 */
+	void publish(std::size_t slot, int device_id, const std::string &tag, const std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t delta_time, int64_t uncertainty);
+
+	/**
+	 * Send all the samples of a block to the sinks, taking their delta times from the timestamps of the block. The
+	 * readings are copied from the columns of the block directly into the queues of the sinks.
+	 */
+	void publish_block(std::size_t slot, int device_id, const std::string &tag, const SampleBlock &block, const ChannelSchema &schema, int64_t uncertainty);
+
+	/**
+	 * Write the samples that are still queued, stop the threads and close the sinks.
+	 */
+	void stop();
+
+	void print_stats(std::ostream &out) const;
+
+	std::size_t size() const {
+		return _sinks.size();
+	}
+
+private:
+	struct SinkThread;
+
+	std::size_t _n_devices;
+	std::vector<std::unique_ptr<SinkThread>> _sinks;
+	bool _stopped = false;
+};
+
+#endif /* SINKS_H_ */
@@ -0,0 +1,430 @@
+/*
+ * TCPClient.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "TCPClient.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace {
+
+/**
+ * Convert a kernel timestamp, which is taken with the realtime clock, to the monotonic clock used by TCPClient::_time.
+ * The offset between the two clocks is measured when the timestamp is converted, shortly after it has been taken.
+ */
+uint64_t kernel_time_to_us(const timespec &ts) {
+	int64_t kernel = static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+	int64_t wall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	int64_t steady = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return kernel - wall + steady;
+}
+
+}
+#endif
+
+using asio::ip::tcp;
+
+TCPClient::TCPClient(asio::io_context &io_context, std::string raw_ip_address, unsigned short port) :
+				_io_context(io_context),
+				_socket(io_context),
+				_receive_buffer(4096, MAX_LINE_LENGTH) {
+	_creation_time = _time();
+	_last_write_time = _creation_time;
+	_last_read_time = _creation_time;
+
+	asio::ip::address ip_address = asio::ip::address::from_string(raw_ip_address, _error);
+	if(_error.value() != 0) {
+		// Provided IP address is invalid. Breaking execution.
+		std::cerr
+				<< "Failed to parse the IP address. Error code = "
+				<< _error.value() << ". Message: " << _error.message() << std::endl;;
+		exit(1);
+	}
+
+	_endpoint.address(ip_address);
+	_endpoint.port(port);
+}
+
+uint64_t TCPClient::_time() {
+	// the intervals must not be affected by changes of the system time, kernel timestamps are converted to this clock
+	auto time = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+void TCPClient::connect() {
+	_socket.connect(_endpoint, _error);
+	if(_error.value() != 0) {
+		// Failed to open the socket.
+		std::cerr
+				<< "Failed to open the socket! Error code = "
+				<< _error.value() << ". Message: " << _error.message() << std::endl;;
+		exit(1);
+	}
+}
+
+void TCPClient::connect_dummy() {
+	_is_dummy = true;
+
+	// each client has its own generator, since clients may live on different threads
+	_dummy_rng.seed(std::time(NULL) ^ reinterpret_cast<std::uintptr_t>(this));
+}
+
+bool TCPClient::enable_kernel_timestamps() {
+#ifdef __linux__
+	if(_is_dummy) {
+		return false;
+	}
+
+	// OPT_ID tags each transmit timestamp with the offset of the last byte it refers to, and OPT_TSONLY avoids
+	// looping the whole packet back to the error queue
+	int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+	if(setsockopt(_socket.native_handle(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0) {
+		return false;
+	}
+
+	_kernel_timestamps = true;
+	_bytes_sent = 0;
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::string TCPClient::_dummy_response() {
+	std::stringstream ss;
+	ss << _dummy_rng() % 1024;
+	for(int i = 0; i < 8; i++) {
+		ss << "," << _dummy_rng() % 1024;
+	}
+	return ss.str();
+}
+
+std::string_view TCPClient::read() {
+	if(_is_dummy) {
+		_last_read_time = _time();
+		_dummy_line = _dummy_response();
+		return _dummy_line;
+	}
+
+	std::string_view line;
+	uint64_t discarded = _receive_buffer.discarded();
+	while(!_receive_buffer.next_line(line)) {
+		if(_receive_buffer.discarded() != discarded) {
+			// the response was too long: there is no point in waiting for its end, which will be skipped on the next call
+			line = std::string_view();
+			break;
+		}
+		std::size_t n = _socket.read_some(_receive_buffer.prepare());
+		_receive_buffer.commit(n);
+	}
+	_last_read_time = _time();
+
+	return line;
+}
+
+void TCPClient::write(const std::string &message) {
+	_last_write_time = _time();
+
+	if(!_is_dummy) {
+		asio::write(_socket, asio::buffer(message + "\r\n"));
+	}
+}
+
+void TCPClient::start_pipelined(const std::string &request, unsigned int depth, std::chrono::microseconds interval, ResponseHandler handler) {
+	_request = request + "\r\n";
+	_depth = (depth > 0) ? depth : 1;
+	_handler = handler;
+	_in_flight.clear();
+
+	if(!_is_dummy) {
+		_read_next();
+	}
+
+	if(interval.count() > 0) {
+		_scheduler.reset(new DeadlineScheduler(_io_context, interval));
+		_scheduler->start([this]() {
+			if(!_can_send()) {
+				return false;
+			}
+			_send();
+			return true;
+		});
+	}
+	else {
+		_send_next();
+	}
+}
+
+void TCPClient::start_streaming(const std::string &start_command, ResponseHandler handler) {
+	_handler = handler;
+	_streaming = true;
+	_in_flight.clear();
+
+	if(_is_dummy) {
+		_stream_dummy();
+		return;
+	}
+
+	_request = start_command + "\r\n";
+	_bytes_sent += _request.size();
+	_writing = true;
+	asio::async_write(_socket, asio::buffer(_request), [this](const asio::error_code &ec, std::size_t) {
+		if(ec) {
+			std::cerr << "Failed to send the start command! Error code = " << ec.value() << ". Message: " << ec.message() << std::endl;
+			exit(1);
+		}
+		_writing = false;
+	});
+	_read_next();
+}
+
+void TCPClient::start_streaming_blocks(const std::string &start_command, BlockHandler handler) {
+	_block_handler = handler;
+	start_streaming(start_command, nullptr);
+}
+
+void TCPClient::_stream_dummy() {
+	asio::post(_io_context, [this]() {
+		_dummy_line = _dummy_response();
+		if(_block_handler) {
+			_dummy_line += '\n';
+			_last_read_time = _time();
+			_block_handler(_last_read_time - _creation_time, _dummy_line);
+		}
+		else {
+			_on_response(_dummy_line, _time());
+		}
+		_stream_dummy();
+	});
+}
+
+bool TCPClient::_can_send() {
+	return !_streaming && !_writing && _in_flight.size() < _depth;
+}
+
+void TCPClient::_send_next() {
+	// when polling periodically, requests are sent by the scheduler only
+	if(!_scheduler && _can_send()) {
+		_send();
+	}
+}
+
+void TCPClient::_send() {
+	_writing = true;
+	_last_write_time = _time();
+	if(!_is_dummy) {
+		_bytes_sent += _request.size();
+	}
+	_in_flight.push_back(Request{_last_write_time - _creation_time, _bytes_sent, false});
+
+	if(_is_dummy) {
+		asio::post(_io_context, [this]() {
+			// the dummy device answers as soon as the request has been "sent"
+			asio::post(_io_context, [this]() {
+				_dummy_line = _dummy_response();
+				_on_response(_dummy_line, _time());
+			});
+			_writing = false;
+			_send_next();
+		});
+	}
+	else {
+		asio::async_write(_socket, asio::buffer(_request), [this](const asio::error_code &ec, std::size_t) {
+			if(ec) {
+				std::cerr << "Failed to send the request! Error code = " << ec.value() << ". Message: " << ec.message() << std::endl;
+				exit(1);
+			}
+			_writing = false;
+			_send_next();
+		});
+	}
+}
+
+void TCPClient::_read_next() {
+	if(_kernel_timestamps) {
+		_read_next_timestamped();
+		return;
+	}
+
+	_socket.async_read_some(_receive_buffer.prepare(), [this](const asio::error_code &ec, std::size_t length) {
+		if(ec) {
+			std::cerr << "Failed to read the response! Error code = " << ec.value() << ". Message: " << ec.message() << std::endl;
+			exit(1);
+		}
+
+		_receive_buffer.commit(length);
+		_on_data(_time());
+		_read_next();
+	});
+}
+
+void TCPClient::_read_next_timestamped() {
+#ifdef __linux__
+	// asio does not give access to ancillary data, hence we wait for the socket to become readable and then read
+	// from it with recvmsg
+	_socket.async_wait(asio::ip::tcp::socket::wait_read, [this](const asio::error_code &ec) {
+		if(ec) {
+			std::cerr << "Failed to read the response! Error code = " << ec.value() << ". Message: " << ec.message() << std::endl;
+			exit(1);
+		}
+
+		// transmit timestamps are made available through the error queue
+		_drain_error_queue();
+
+		asio::mutable_buffer buffer = _receive_buffer.prepare();
+		iovec iov = {buffer.data(), buffer.size()};
+		char control[CMSG_SPACE(sizeof(scm_timestamping))];
+		msghdr msg = {};
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		ssize_t length = recvmsg(_socket.native_handle(), &msg, MSG_DONTWAIT);
+		if(length < 0) {
+			if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+				_read_next();
+				return;
+			}
+			std::cerr << "Failed to read the response! Error code = " << errno << ". Message: " << std::strerror(errno) << std::endl;
+			exit(1);
+		}
+		if(length == 0) {
+			std::cerr << "Failed to read the response! The connection has been closed by the device" << std::endl;
+			exit(1);
+		}
+
+		uint64_t receive_time = _time();
+		for(cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+				auto *ts = reinterpret_cast<scm_timestamping*>(CMSG_DATA(cmsg));
+				// ts[0] holds the software timestamp
+				if(ts->ts[0].tv_sec != 0) {
+					receive_time = kernel_time_to_us(ts->ts[0]);
+				}
+			}
+		}
+
+		_receive_buffer.commit(length);
+		_on_data(receive_time);
+		_read_next();
+	});
+#endif
+}
+
+void TCPClient::_drain_error_queue() {
+#ifdef __linux__
+	while(true) {
+		char control[512];
+		msghdr msg = {};
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		if(recvmsg(_socket.native_handle(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+			return;
+		}
+
+		uint64_t transmit_time = 0;
+		int64_t last_byte = -1;
+		for(cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+				auto *ts = reinterpret_cast<scm_timestamping*>(CMSG_DATA(cmsg));
+				transmit_time = kernel_time_to_us(ts->ts[0]);
+			}
+			else if((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+				auto *err = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cmsg));
+				if(err->ee_origin == SO_EE_ORIGIN_TIMESTAMPING) {
+					last_byte = err->ee_data;
+				}
+			}
+		}
+
+		if(transmit_time == 0 || last_byte < 0) {
+			continue;
+		}
+
+		// the timestamp refers to the segment that contains the given byte, and hence to all the requests that
+		// end on or before it and have not been timestamped yet
+		for(auto &request : _in_flight) {
+			if(request.end_offset > static_cast<uint64_t>(last_byte) + 1) {
+				break;
+			}
+			if(!request.kernel_time) {
+				request.write_time = transmit_time - _creation_time;
+				request.kernel_time = true;
+			}
+		}
+	}
+#endif
+}
+
+void TCPClient::_on_data(uint64_t receive_time) {
+	if(_block_handler) {
+		std::string_view lines;
+		if(_receive_buffer.next_lines(lines)) {
+			_last_read_time = receive_time;
+			_block_handler(receive_time - _creation_time, lines);
+		}
+		return;
+	}
+
+	// a single read may contain several responses
+	std::string_view response;
+	while(_receive_buffer.next_line(response)) {
+		_on_response(response, receive_time);
+	}
+	_retire_discarded();
+}
+
+void TCPClient::_retire_discarded() {
+	// a request whose response has been discarded will not be answered anymore: make room for the next one
+	for(; _retired_lines < _receive_buffer.discarded(); _retired_lines++) {
+		if(!_in_flight.empty()) {
+			_in_flight.pop_front();
+		}
+		_send_next();
+	}
+}
+
+void TCPClient::_on_response(std::string_view response, uint64_t receive_time) {
+	_last_read_time = receive_time;
+	uint64_t read_time = _last_read_time - _creation_time;
+
+	uint64_t write_time = read_time;
+	// responses come back in the same order as the requests, hence they can be matched FIFO-style
+	if(!_in_flight.empty()) {
+		write_time = _in_flight.front().write_time;
+		_in_flight.pop_front();
+	}
+
+	_handler(write_time, read_time, response);
+	_send_next();
+}
+
+void TCPClient::set_interval(std::chrono::microseconds interval) {
+	if(_scheduler) {
+		_scheduler->set_period(interval);
+	}
+}
+
+uint64_t TCPClient::last_write_time() {
+	return _last_write_time - _creation_time;
+}
+
+uint64_t TCPClient::last_read_time() {
+	return _last_read_time - _creation_time;
+}
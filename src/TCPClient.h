@@ -0,0 +1,179 @@
+/*
+ * TCPClient.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef TCPCLIENT_H_
+#define TCPCLIENT_H_
+
+#include "DeadlineScheduler.h"
+#include "LineBuffer.h"
+
+#include <asio.hpp>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+
+class TCPClient {
+public:
+	/// lines longer than this, in bytes, are discarded so that a device that never sends a newline cannot exhaust the memory
+	static constexpr std::size_t MAX_LINE_LENGTH = 1 << 20;
+
+	/**
+	 * Signature of the callbacks invoked by the asynchronous polling engine. Times are given in microseconds
+	 * and are relative to the creation of the client.
+	 *
+	 * @param write_time time at which the request that generated the response was sent
+	 * @param read_time time at which the response was received
+	 * @param response the response, without the trailing newline. The view is valid only during the call
+	 */
+	using ResponseHandler = std::function<void(uint64_t write_time, uint64_t read_time, std::string_view response)>;
+
+	/**
+	 * Signature of the callbacks that consume the received lines in bursts.
+	 *
+	 * @param read_time time at which the lines were received, relative to the creation of the client
+	 * @param lines one or more lines, each terminated by a newline. The view is valid only during the call
+	 */
+	using BlockHandler = std::function<void(uint64_t read_time, std::string_view lines)>;
+
+	/**
+	 * @param io_context the event loop the asynchronous operations of the client will be run on. Several clients can share the same loop
+	 * @param raw_ip_address
+	 * @param port
+	 */
+	TCPClient(asio::io_context &io_context, std::string raw_ip_address, unsigned short port);
+
+	void connect();
+	void connect_dummy();
+
+	/**
+	 * Ask the kernel to timestamp the requests when they leave the TCP stack and the responses when they are
+	 * received, and use these timestamps in place of the user-space ones. Must be called after connect() and
+	 * before the polling starts. Supported on Linux only.
+	 *
+	 * @return true if kernel timestamps have been enabled, false otherwise
+	 */
+	bool enable_kernel_timestamps();
+	/**
+	 * Block until a complete line has been received and return it. The returned view points into the receive buffer
+	 * and is valid until the next call to read(). If the line is longer than MAX_LINE_LENGTH, it is discarded and an
+	 * empty view is returned as soon as the limit is exceeded, see discarded_lines().
+	 */
+	std::string_view read();
+	void write(const std::string &message);
+
+	/**
+	 * Start polling the device asynchronously. Up to depth requests are kept in flight at the same time, and each
+	 * response is matched to the timestamp of the oldest outstanding request (the device answers in order).
+	 * Nothing happens until the io_context the client has been built with is run.
+	 *
+	 * @param request the request that will be sent to the device (e.g. "MS")
+	 * @param depth the maximum number of outstanding requests
+	 * @param interval the polling period. If larger than zero, requests are sent at exact multiples of the period and
+	 * the periods during which the pipeline is full are counted as missed deadlines. If zero, a new request is sent
+	 * as soon as there is room in the pipeline
+	 * @param handler callback invoked on each response
+	 */
+	void start_pipelined(const std::string &request, unsigned int depth, std::chrono::microseconds interval, ResponseHandler handler);
+
+	/**
+	 * Start consuming the continuous stream of readings of a device that pushes them on its own. The start command
+	 * is sent once, and then every newline-terminated line that is received is passed to the handler, with both
+	 * write_time and read_time set to the time at which the line was received.
+	 * Nothing happens until the io_context the client has been built with is run.
+	 *
+	 * @param start_command the command that makes the device start streaming
+	 * @param handler callback invoked on each line
+	 */
+	void start_streaming(const std::string &start_command, ResponseHandler handler);
+
+	/**
+	 * Same as start_streaming(), but all the lines that are available after each read are passed to the handler at
+	 * once, so that they can be parsed in batch.
+	 *
+	 * @param start_command the command that makes the device start streaming
+	 * @param handler callback invoked on each burst of lines
+	 */
+	void start_streaming_blocks(const std::string &start_command, BlockHandler handler);
+
+	uint64_t last_write_time();
+	uint64_t last_read_time();
+
+	/**
+	 * Return the number of received lines that have been discarded because they were longer than MAX_LINE_LENGTH.
+	 */
+	uint64_t discarded_lines() const {
+		return _receive_buffer.discarded();
+	}
+
+	/**
+	 * Return the scheduler that paces the requests, or nullptr if the client is not polling periodically.
+	 */
+	const DeadlineScheduler *scheduler() const {
+		return _scheduler.get();
+	}
+
+	/**
+	 * Change the polling period. Has an effect only if the client is polling periodically.
+	 */
+	void set_interval(std::chrono::microseconds interval);
+private:
+	uint64_t _time();
+
+	bool _can_send();
+	void _send();
+	void _send_next();
+	void _read_next();
+	void _read_next_timestamped();
+	void _drain_error_queue();
+	void _stream_dummy();
+	void _on_data(uint64_t receive_time);
+	void _on_response(std::string_view response, uint64_t receive_time);
+	void _retire_discarded();
+	std::string _dummy_response();
+
+	uint64_t _creation_time;
+	uint64_t _last_write_time;
+	uint64_t _last_read_time;
+	asio::error_code _error;
+	asio::io_context &_io_context;
+	asio::ip::tcp::endpoint _endpoint;
+	asio::ip::tcp::socket _socket;
+	bool _is_dummy = false;
+	std::string _dummy_line;
+	std::minstd_rand _dummy_rng;
+	LineBuffer _receive_buffer;
+	// number of discarded lines whose requests have already been taken out of the pipeline
+	uint64_t _retired_lines = 0;
+
+	// state of the asynchronous polling engine
+	std::string _request;
+	unsigned int _depth = 1;
+	std::unique_ptr<DeadlineScheduler> _scheduler;
+	ResponseHandler _handler;
+	BlockHandler _block_handler;
+	struct Request {
+		// relative time at which the request was sent
+		uint64_t write_time;
+		// number of bytes written on the socket once the request has been sent
+		uint64_t end_offset;
+		// true if write_time comes from a kernel timestamp
+		bool kernel_time;
+	};
+	// the requests that have not been answered yet, oldest first
+	std::deque<Request> _in_flight;
+	uint64_t _bytes_sent = 0;
+	bool _writing = false;
+	bool _streaming = false;
+	bool _kernel_timestamps = false;
+};
+
+#endif /* TCPCLIENT_H_ */
@@ -0,0 +1,152 @@
+/*
+ * TimeFormatter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "TimeFormatter.h"
+
+#include "strings.h"
+
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * The formatted representation of the local time of a given second.
+ */
+struct SecondCache {
+	int64_t second = std::numeric_limits<int64_t>::min();
+	// the text that comes before the fractional part
+	char prefix[32];
+	std::size_t prefix_length = 0;
+	// the text that comes after the fractional part
+	char suffix[8];
+	std::size_t suffix_length = 0;
+};
+
+thread_local SecondCache clock_cache;
+thread_local SecondCache iso_cache;
+
+void append_padded(std::string &out, uint64_t value, int digits) {
+	char buffer[16];
+	for(int i = digits - 1; i >= 0; i--) {
+		buffer[i] = '0' + value % 10;
+		value /= 10;
+	}
+	out.append(buffer, digits);
+}
+
+void update_clock(SecondCache &cache, int64_t second) {
+	std::time_t time = second;
+	std::tm local;
+	localtime_r(&time, &local);
+	cache.prefix_length = std::strftime(cache.prefix, sizeof(cache.prefix), "%T.", &local);
+	cache.suffix_length = 0;
+	cache.second = second;
+}
+
+void update_iso(SecondCache &cache, int64_t second) {
+	std::time_t time = second;
+	std::tm local;
+	localtime_r(&time, &local);
+	cache.prefix_length = std::strftime(cache.prefix, sizeof(cache.prefix), "%Y-%m-%dT%H:%M:%S.", &local);
+
+	// %z gives +hhmm, while ISO 8601 wants +hh:mm
+	char offset[8];
+	if(std::strftime(offset, sizeof(offset), "%z", &local) == 5) {
+		std::memcpy(cache.suffix, offset, 3);
+		cache.suffix[3] = ':';
+		std::memcpy(cache.suffix + 4, offset + 3, 2);
+		cache.suffix_length = 6;
+	}
+	else {
+		cache.suffix_length = 0;
+	}
+	cache.second = second;
+}
+
+const char *format_names[] = {"clock", "iso8601", "epoch-ns", "relative"};
+
+}
+
+TimeFormatter::TimeFormatter(TimeFormat format) :
+				_format(format),
+				_start(std::chrono::steady_clock::now()) {
+
+}
+
+TimeFormat TimeFormatter::parse_format(const std::string &name) {
+	for(std::size_t i = 0; i < sizeof(format_names) / sizeof(format_names[0]); i++) {
+		if(name == format_names[i]) {
+			return static_cast<TimeFormat>(i);
+		}
+	}
+
+	std::string message = "unknown time format '" + name + "'. Available formats:";
+	for(auto &format : available_formats()) {
+		message += " " + format;
+	}
+	throw std::invalid_argument(message);
+}
+
+std::vector<std::string> TimeFormatter::available_formats() {
+	return std::vector<std::string>(std::begin(format_names), std::end(format_names));
+}
+
+void TimeFormatter::append(std::string &out) const {
+	if(_format == TimeFormat::RELATIVE_US) {
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start);
+		utils::append_number(out, elapsed.count());
+		return;
+	}
+
+	append(out, std::chrono::system_clock::now());
+}
+
+void TimeFormatter::append(std::string &out, std::chrono::system_clock::time_point now) const {
+	// the monotonic clock is read only if it is needed
+	append(out, now, (_format == TimeFormat::RELATIVE_US) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point());
+}
+
+void TimeFormatter::append(std::string &out, std::chrono::system_clock::time_point now, std::chrono::steady_clock::time_point steady_now) const {
+	int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+	int64_t second = ns / 1000000000;
+	int64_t fraction = ns % 1000000000;
+
+	switch(_format) {
+	case TimeFormat::CLOCK:
+		if(second != clock_cache.second) {
+			update_clock(clock_cache, second);
+		}
+		out.append(clock_cache.prefix, clock_cache.prefix_length);
+		append_padded(out, fraction / 1000000, 3);
+		break;
+	case TimeFormat::ISO8601:
+		if(second != iso_cache.second) {
+			update_iso(iso_cache, second);
+		}
+		out.append(iso_cache.prefix, iso_cache.prefix_length);
+		append_padded(out, fraction / 1000, 6);
+		out.append(iso_cache.suffix, iso_cache.suffix_length);
+		break;
+	case TimeFormat::EPOCH_NS:
+		utils::append_number(out, ns);
+		break;
+	case TimeFormat::RELATIVE_US: {
+		auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(steady_now - _start);
+		utils::append_number(out, elapsed.count());
+		break;
+	}
+	}
+}
+
+std::string TimeFormatter::now() const {
+	std::string out;
+	append(out);
+	return out;
+}
@@ -0,0 +1,77 @@
+/*
+ * TimeFormatter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef TIMEFORMATTER_H_
+#define TIMEFORMATTER_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * The formats the current time can be printed in.
+ */
+enum class TimeFormat {
+	/// local time, HH:MM:SS.mmm
+	CLOCK,
+	/// local time, ISO 8601 with microseconds and UTC offset (e.g. 2026-10-17T14:03:27.123456+02:00)
+	ISO8601,
+	/// nanoseconds since the Unix epoch
+	EPOCH_NS,
+	/// microseconds since the creation of the formatter, measured with a monotonic clock
+	RELATIVE_US
+};
+
+/**
+ * Appends the current time to a string in one of the supported formats. The part of the local time that changes at
+ * most once per second is formatted only when the second changes and then cached, so that only the fractional part
+ * has to be formatted for each sample. Each thread has its own cache, hence the formatter can be shared by threads
+ * without locking.
+ */
+class TimeFormatter {
+public:
+	TimeFormatter(TimeFormat format=TimeFormat::CLOCK);
+
+	/**
+	 * Return the format with the given name (clock, iso8601, epoch-ns or relative). Throws std::invalid_argument
+	 * if there is no such format.
+	 */
+	static TimeFormat parse_format(const std::string &name);
+
+	static std::vector<std::string> available_formats();
+
+	/**
+	 * Append the current time.
+	 */
+	void append(std::string &out) const;
+
+	/**
+	 * Append the given time. The monotonic clock is read only by the RELATIVE_US format.
+	 */
+	void append(std::string &out, std::chrono::system_clock::time_point now) const;
+
+	/**
+	 * Append the given time, which was taken at steady_now on the monotonic clock. RELATIVE_US is computed from
+	 * steady_now, so that it is not affected by changes of the system time, while the other formats use now.
+	 */
+	void append(std::string &out, std::chrono::system_clock::time_point now, std::chrono::steady_clock::time_point steady_now) const;
+
+	/**
+	 * Return the current time as a new string.
+	 */
+	std::string now() const;
+
+	TimeFormat format() const {
+		return _format;
+	}
+
+private:
+	TimeFormat _format;
+	std::chrono::steady_clock::time_point _start;
+};
+
+#endif /* TIMEFORMATTER_H_ */
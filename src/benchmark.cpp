@@ -0,0 +1,389 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <tclap/CmdLine.h>
+
+#include "parser.h"
+#include "SampleBlock.h"
+#include "ShardedExecutor.h"
+#include "strings.h"
+#include "TCPClient.h"
+#include "TimeFormatter.h"
+
+// count the heap allocations, so that benchmarks can report how many of them each operation performs
+std::atomic<uint64_t> n_allocations(0);
+
+// every replaced operator new has a matching operator delete releasing the memory with std::free. The deletes are
+// kept out of line together with operator new, otherwise the compiler sees them as mismatched allocation functions
+__attribute__((noinline)) void *operator new(std::size_t size) {
+	n_allocations.fetch_add(1, std::memory_order_relaxed);
+	void *ptr = std::malloc(size);
+	if(ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void *operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	operator delete(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	operator delete(ptr);
+}
+
+/**
+ * Poll n_devices dummy devices for the given amount of time on an executor with n_threads shards and return the
+ * number of samples that have been parsed and formatted per second.
+ */
+double executor_throughput(unsigned int n_threads, unsigned int n_devices, bool pin_threads, std::chrono::milliseconds duration) {
+	ShardedExecutor executor(n_threads, pin_threads);
+
+	std::vector<std::unique_ptr<TCPClient>> clients;
+	// one counter per device, padded to avoid false sharing between shards
+	struct alignas(64) Counter {
+		uint64_t samples = 0;
+		uint64_t checksum = 0;
+	};
+	std::vector<Counter> counters(n_devices);
+
+	ChannelSchema schema;
+	for(unsigned int i = 0; i < n_devices; i++) {
+		clients.emplace_back(new TCPClient(executor.next_shard(), "127.0.0.1", 6000));
+		clients.back()->connect_dummy();
+		Counter &counter = counters[i];
+		clients.back()->start_pipelined("MS", 1, std::chrono::microseconds(0), [&counter, &schema](uint64_t write_time, uint64_t read_time, std::string_view message) {
+			std::vector<ChannelValue> values;
+			parse_message(message, values, schema);
+			std::string line = std::to_string((write_time + read_time) / 2);
+			for(auto value : values) {
+				line += " " + std::to_string(value.i);
+			}
+			counter.samples++;
+			counter.checksum += line.size();
+		});
+	}
+
+	std::thread stopper([&executor, duration]() {
+		std::this_thread::sleep_for(duration);
+		executor.stop();
+	});
+
+	auto start = std::chrono::steady_clock::now();
+	executor.run();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	stopper.join();
+
+	uint64_t samples = 0;
+	for(auto &counter : counters) {
+		samples += counter.samples;
+	}
+
+	return samples / elapsed.count();
+}
+
+/**
+ * The parser used before the introduction of the zero-copy one, kept as a reference.
+ */
+std::vector<int> split_parse_message(const std::string &message) {
+	auto spl = utils::split(message, ",");
+	std::vector<int> results(spl.size() / 3);
+	for(uint i = 0; i < spl.size() / 3; i++) {
+		results[i] = std::stoi(spl[2 * i + 2]);
+	}
+
+	return results;
+}
+
+/**
+ * Process the same message n_iterations times with the given parser and print the time and the number of heap allocations per message.
+ */
+template<typename Parser>
+double parse_benchmark(const std::string &name, const std::string &message, uint64_t n_iterations, Parser parser) {
+	uint64_t checksum = 0;
+	uint64_t allocations = n_allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	for(uint64_t i = 0; i < n_iterations; i++) {
+		checksum += parser(message);
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	allocations = n_allocations.load() - allocations;
+
+	double ns_per_message = elapsed.count() / n_iterations;
+	std::cout << name << " " << std::fixed << std::setprecision(1) << ns_per_message << " " << std::setprecision(2) << (double) allocations / n_iterations;
+	std::cout << " (checksum " << checksum << ")" << std::endl;
+
+	return ns_per_message;
+}
+
+void run_parse_benchmarks(uint64_t n_iterations) {
+	// a typical 16-channel response
+	std::string message;
+	for(int i = 0; i < 48; i++) {
+		message += ((i > 0) ? "," : "") + std::to_string((i % 3 == 2) ? 100000 + 37 * i : i);
+	}
+
+	std::cout << "# parse_message, " << message.size() << "-byte message" << std::endl;
+	std::cout << "# parser ns/message allocations/message" << std::endl;
+	double reference = parse_benchmark("split", message, n_iterations, [](const std::string &msg) {
+		auto values = split_parse_message(msg);
+		return values.back();
+	});
+
+	ChannelSchema schema;
+	std::vector<ChannelValue> values;
+	values.reserve(64);
+	double zero_copy = parse_benchmark("zero-copy", message, n_iterations, [&values, &schema](const std::string &msg) {
+		parse_message(msg, values, schema);
+		return values.back().i;
+	});
+
+	std::cout << "# speedup " << std::setprecision(2) << reference / zero_copy << std::endl;
+
+	FixedLayout<3, 2, 16>::Values fixed_values;
+	double fixed = parse_benchmark("fixed-3:2:16", message, n_iterations, [&fixed_values, &schema](const std::string &msg) {
+		FixedLayout<3, 2, 16>::parse(msg, fixed_values, schema);
+		return fixed_values.back().i;
+	});
+	std::cout << "# speedup " << std::setprecision(2) << reference / fixed << std::endl;
+
+	// only 4 channels out of 16 are converted
+	double selected = parse_benchmark("fixed-3:2:16, 4 channels", message, n_iterations, [&fixed_values, &schema](const std::string &msg) {
+		FixedLayout<3, 2, 16>::parse(msg, fixed_values, schema, 0b1000100010001);
+		return fixed_values[3].i;
+	});
+	std::cout << "# speedup " << std::setprecision(2) << reference / selected << std::endl;
+
+	// the same readings, converted as floating-point and fixed-point numbers
+	ChannelSchema double_schema = ChannelSchema::parse("double");
+	double doubles = parse_benchmark("zero-copy, double", message, n_iterations, [&values, &double_schema](const std::string &msg) {
+		parse_message(msg, values, double_schema);
+		return static_cast<int>(values.back().d);
+	});
+	std::cout << "# speedup " << std::setprecision(2) << reference / doubles << std::endl;
+
+	ChannelSchema fixed_schema = ChannelSchema::parse("fixed2");
+	double fixed_point = parse_benchmark("zero-copy, fixed2", message, n_iterations, [&values, &fixed_schema](const std::string &msg) {
+		parse_message(msg, values, fixed_schema);
+		return values.back().i;
+	});
+	std::cout << "# speedup " << std::setprecision(2) << reference / fixed_point << std::endl;
+
+	// a burst of responses, parsed line by line into a vector and in batch into a columnar block
+	const std::size_t n_lines = 1024;
+	std::string burst;
+	for(std::size_t i = 0; i < n_lines; i++) {
+		burst += message + "\n";
+	}
+	uint64_t n_bursts = std::max<uint64_t>(n_iterations / n_lines, 1);
+
+	std::cout << "# burst of " << n_lines << " lines" << std::endl;
+	std::cout << "# parser ns/burst allocations/burst" << std::endl;
+	double per_line = parse_benchmark("line-by-line", burst, n_bursts, [&values, &schema](const std::string &buffer) {
+		int checksum = 0;
+		std::string_view lines(buffer);
+		std::size_t newline;
+		while((newline = lines.find('\n')) != std::string_view::npos) {
+			parse_message(lines.substr(0, newline), values, schema);
+			checksum += values.back().i;
+			lines.remove_prefix(newline + 1);
+		}
+		return checksum;
+	}) / n_lines;
+
+	// the block parser splits the burst into fields with the vectorised tokenizer
+	SampleBlock block(n_lines);
+	for(auto isa : {utils::TokenizerISA::SCALAR, utils::TokenizerISA::SSE2, utils::TokenizerISA::AVX2}) {
+		BlockParser block_parser(layout_parser("dl"), schema, ALL_CHANNELS, isa);
+		std::string name = std::string("block, ") + utils::tokenizer_isa_name(isa);
+		double batch = parse_benchmark(name, burst, n_bursts, [&block, &block_parser](const std::string &buffer) {
+			block.clear();
+			block_parser.parse(buffer, 0, block);
+			const ChannelValue *column = block.column(block.n_channels() - 1);
+			int checksum = 0;
+			for(std::size_t i = 0; i < block.size(); i++) {
+				checksum += column[i].i;
+			}
+			return checksum;
+		}) / n_lines;
+		std::cout << "# per message: line-by-line " << std::setprecision(1) << per_line << " ns, " << name << " " << batch << " ns" << std::endl;
+	}
+}
+
+/**
+ * The strpbrk-based split used before the introduction of the vectorised tokenizer, kept as a reference.
+ */
+std::vector<std::string> strpbrk_split(const std::string &str, const std::string &delims) {
+	std::vector<std::string> output;
+	output.reserve(15);
+
+	const char *ptr = str.c_str();
+	while(ptr) {
+		auto base = ptr;
+		ptr = std::strpbrk(ptr, delims.c_str());
+		if(ptr) {
+			if(ptr - base) {
+				output.emplace_back(base, ptr - base);
+			}
+			ptr++;
+		}
+		else {
+			output.emplace_back(base);
+		}
+	}
+
+	return output;
+}
+
+void run_tokenize_benchmarks(uint64_t n_iterations) {
+	std::string line;
+	for(int i = 0; i < 48; i++) {
+		line += ((i > 0) ? "," : "") + std::to_string(100000 + 37 * i);
+	}
+	const int n_lines = 256;
+	std::string buffer;
+	for(int i = 0; i < n_lines; i++) {
+		buffer += line + "\n";
+	}
+
+	std::cout << "# tokenizer, " << line.size() << "-byte line, best instruction set: " << utils::tokenizer_isa_name() << std::endl;
+	std::cout << "# tokenizer ns/line allocations/line" << std::endl;
+	double reference = parse_benchmark("strpbrk", line, n_iterations, [](const std::string &msg) {
+		return strpbrk_split(msg, ",").size();
+	});
+
+	std::vector<utils::Token> tokens;
+	for(auto isa : {utils::TokenizerISA::SCALAR, utils::TokenizerISA::SSE2, utils::TokenizerISA::AVX2}) {
+		double elapsed = parse_benchmark(utils::tokenizer_isa_name(isa), line, n_iterations, [&tokens, isa](const std::string &msg) {
+			utils::tokenize(msg, ",", tokens, isa);
+			return tokens.size();
+		});
+		std::cout << "# speedup " << std::setprecision(2) << reference / elapsed << std::endl;
+	}
+
+	utils::TokenizedLines batch;
+	double elapsed = parse_benchmark("batch", buffer, std::max<uint64_t>(n_iterations / n_lines, 1), [&batch](const std::string &buf) {
+		utils::tokenize_lines(buf, ",", batch);
+		return batch.tokens.size();
+	});
+	std::cout << "# batch of " << n_lines << " lines, ns/line " << std::setprecision(1) << elapsed / n_lines << std::endl;
+}
+
+/**
+ * The timestamp formatting used before the introduction of TimeFormatter, kept as a reference.
+ */
+std::string put_time_current_time() {
+	auto now = std::chrono::system_clock::now();
+	auto in_time_t = std::chrono::system_clock::to_time_t(now);
+	auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) -
+			std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch());
+
+	std::stringstream ss;
+	ss << std::put_time(std::localtime(&in_time_t), "%T") << "." << std::setfill('0') << std::setw(3) << ms.count();
+	return ss.str();
+}
+
+void run_time_benchmarks(uint64_t n_iterations) {
+	std::cout << "# current time formatting" << std::endl;
+	std::cout << "# format ns/call allocations/call" << std::endl;
+	double reference = parse_benchmark("put_time", "", n_iterations, [](const std::string &) {
+		return put_time_current_time().size();
+	});
+
+	std::string line;
+	line.reserve(64);
+	for(auto &name : TimeFormatter::available_formats()) {
+		TimeFormatter formatter(TimeFormatter::parse_format(name));
+		double elapsed = parse_benchmark(name, "", n_iterations, [&formatter, &line](const std::string &) {
+			line.clear();
+			formatter.append(line);
+			return line.size();
+		});
+		std::cout << "# speedup " << std::setprecision(2) << reference / elapsed << std::endl;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		TCLAP::CmdLine cmd("PADL benchmarks", ' ', "0.1");
+
+		std::vector<std::string> allowed_benchmarks = {"all", "executor", "parse", "time", "tokenize"};
+		TCLAP::ValuesConstraint<std::string> benchmark_constraint(allowed_benchmarks);
+		TCLAP::UnlabeledValueArg<std::string> benchmark_arg("benchmark", "The benchmark to be run", false, "all", &benchmark_constraint);
+		TCLAP::ValueArg<uint64_t> iterations_arg("i", "iterations", "Number of iterations of the micro-benchmarks", false, 1000000, "iterations");
+
+		TCLAP::ValueArg<unsigned int> devices_arg("n", "devices", "Number of dummy devices", false, 64, "devices");
+		TCLAP::ValueArg<unsigned int> max_threads_arg("t", "max-threads", "Maximum number of threads (0 means one per core)", false, 0, "threads");
+		TCLAP::ValueArg<int> duration_arg("", "duration", "Duration of each run (in milliseconds)", false, 2000, "milliseconds");
+		TCLAP::SwitchArg pin_arg("", "pin-threads", "Pin each thread to its own core (Linux only)", false);
+
+		cmd.add(benchmark_arg);
+		cmd.add(iterations_arg);
+		cmd.add(devices_arg);
+		cmd.add(max_threads_arg);
+		cmd.add(duration_arg);
+		cmd.add(pin_arg);
+
+		cmd.parse(argc, argv);
+
+		unsigned int max_threads = max_threads_arg.getValue();
+		if(max_threads == 0) {
+			max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		auto duration = std::chrono::milliseconds(duration_arg.getValue());
+
+		std::string benchmark = benchmark_arg.getValue();
+
+		if(benchmark == "all" || benchmark == "parse") {
+			run_parse_benchmarks(iterations_arg.getValue());
+		}
+
+		if(benchmark == "all" || benchmark == "tokenize") {
+			run_tokenize_benchmarks(iterations_arg.getValue());
+		}
+
+		if(benchmark == "all" || benchmark == "time") {
+			run_time_benchmarks(iterations_arg.getValue());
+		}
+
+		if(benchmark != "all" && benchmark != "executor") {
+			return 0;
+		}
+
+		std::cout << "# executor scaling, " << devices_arg.getValue() << " dummy devices, " << std::thread::hardware_concurrency() << " cores" << std::endl;
+		std::cout << "# threads samples/s speedup efficiency" << std::endl;
+		double reference = 0.;
+		for(unsigned int n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+			double throughput = executor_throughput(n_threads, devices_arg.getValue(), pin_arg.getValue(), duration);
+			if(n_threads == 1) {
+				reference = throughput;
+			}
+			double speedup = throughput / reference;
+			std::cout << n_threads << " " << std::fixed << std::setprecision(0) << throughput << " " << std::setprecision(2) << speedup << " " << speedup / n_threads << std::endl;
+		}
+	}
+	catch(TCLAP::ArgException &e) {
+		std::cerr << "ERROR: " << e.error() << " for arg " << e.argId() << std::endl;
+	}
+
+	return 0;
+}
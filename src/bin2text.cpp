@@ -0,0 +1,92 @@
+#include <iostream>
+#include <fstream>
+#include <tclap/CmdLine.h>
+
+#include "BinaryFormat.h"
+#include "strings.h"
+#include "TimeFormatter.h"
+
+/**
+ * Convert a binary log written by "client --format binary" back to the text format printed by the client.
+ */
+int main(int argc, char *argv[]) {
+	try {
+		TCLAP::CmdLine cmd("Convert PADL binary logs to text", ' ', "0.1");
+
+		TCLAP::UnlabeledValueArg<std::string> input_arg("input", "The binary log to be converted. If not given, the log is read from the standard input", false, "", "filename");
+		TCLAP::ValueArg<std::string> time_format_arg("", "time-format", "Format of the current_time column: clock, iso8601, epoch-ns or relative (microseconds since the log was started), defaults to clock", false, "clock", "format");
+
+		cmd.add(input_arg);
+		cmd.add(time_format_arg);
+
+		cmd.parse(argc, argv);
+
+		TimeFormat time_format;
+		try {
+			time_format = TimeFormatter::parse_format(time_format_arg.getValue());
+		}
+		catch(std::invalid_argument &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		TimeFormatter formatter(time_format);
+
+		std::ifstream input_file;
+		if(input_arg.isSet()) {
+			input_file.open(input_arg.getValue(), std::ios::binary);
+			if(!input_file) {
+				std::cerr << "ERROR: cannot open '" << input_arg.getValue() << "'" << std::endl;
+				return 1;
+			}
+		}
+		std::istream &input = (input_arg.isSet()) ? input_file : std::cin;
+
+		try {
+			BinaryReader reader(input);
+			BinaryRecord record;
+			std::string line;
+			const BinaryDevice *device = nullptr;
+			ChannelSchema schema;
+			while(reader.next(record)) {
+				// the schema has to be rebuilt only when the description of the device changes
+				if(record.device != device || record.device->specs.size() != record.values.size()) {
+					device = record.device;
+					schema = ChannelSchema(device->specs);
+				}
+
+				line.clear();
+				if(device->device_id >= 0) {
+					line += device->tag;
+					line += ' ';
+				}
+				utils::append_number(line, record.delta_time);
+				line += ' ';
+				if(record.uncertainty >= 0) {
+					utils::append_number(line, record.uncertainty);
+					line += ' ';
+				}
+				if(time_format == TimeFormat::RELATIVE_US) {
+					utils::append_number(line, (record.epoch_ns - reader.start_time()) / 1000);
+				}
+				else {
+					auto time = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(record.epoch_ns)));
+					formatter.append(line, time);
+				}
+				append_readings(line, record.values, schema);
+				line += '\n';
+
+				std::cout << line;
+			}
+		}
+		catch(bad_binary_log &e) {
+			std::cout.flush();
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+	}
+	catch(TCLAP::ArgException &e) {
+		std::cerr << "ERROR: " << e.error() << " for arg " << e.argId() << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * channels.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "channels.h"
+
+#include "strings.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+const int64_t powers_of_ten[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+}
+
+ChannelSchema::ChannelSchema() :
+				_specs(1) {
+
+}
+
+ChannelSchema::ChannelSchema(std::vector<ChannelSpec> specs) :
+				_specs(specs) {
+	if(_specs.empty()) {
+		_specs.emplace_back();
+	}
+}
+
+ChannelSchema ChannelSchema::parse(const std::string &source) {
+	ChannelSchema schema;
+	schema._specs.clear();
+
+	for(auto &token : utils::split(source, ", ")) {
+		ChannelSpec spec;
+		if(token == "int") {
+			spec.type = ChannelType::INT32;
+		}
+		else if(token == "double") {
+			spec.type = ChannelType::DOUBLE;
+		}
+		else if(utils::starts_with(token, "fixed")) {
+			spec.type = ChannelType::FIXED;
+			if(utils::try_parse(std::string_view(token).substr(5), spec.decimals) != utils::ParseStatus::OK || spec.decimals < 0 || spec.decimals > MAX_DECIMALS) {
+				throw std::invalid_argument("invalid fixed-point type '" + token + "', the number of decimal digits should be between 0 and " + std::to_string(MAX_DECIMALS));
+			}
+		}
+		else {
+			throw std::invalid_argument("unknown channel type '" + token + "' (should be int, double or fixedN)");
+		}
+		schema._specs.push_back(spec);
+	}
+
+	if(schema._specs.empty()) {
+		throw std::invalid_argument("empty list of channel types");
+	}
+
+	return schema;
+}
+
+ChannelSchema ChannelSchema::select(uint64_t channel_mask) const {
+	if(channel_mask == ALL_CHANNELS) {
+		return *this;
+	}
+
+	ChannelSchema selected;
+	selected._specs.clear();
+	for(std::size_t channel = 0; channel < 64; channel++) {
+		if(channel_selected(channel_mask, channel)) {
+			selected._specs.push_back((*this)[channel]);
+		}
+	}
+	if(selected._specs.empty()) {
+		selected._specs.push_back(_specs.back());
+	}
+
+	return selected;
+}
+
+bool convert_reading(std::string_view field, const ChannelSpec &spec, ChannelValue &value) {
+	switch(spec.type) {
+	case ChannelType::INT32:
+		return utils::try_parse(field, value.i) == utils::ParseStatus::OK;
+	case ChannelType::DOUBLE:
+		return utils::try_parse(field, value.d) == utils::ParseStatus::OK;
+	case ChannelType::FIXED: {
+		double real;
+		if(utils::try_parse(field, real) != utils::ParseStatus::OK) {
+			return false;
+		}
+		double scaled = std::round(real * powers_of_ten[spec.decimals]);
+		if(scaled < std::numeric_limits<int32_t>::min() || scaled > std::numeric_limits<int32_t>::max()) {
+			return false;
+		}
+		value.i = static_cast<int32_t>(scaled);
+		return true;
+	}
+	}
+
+	return false;
+}
+
+ChannelValue bad_reading(const ChannelSpec &spec) {
+	ChannelValue value;
+	if(spec.type == ChannelType::DOUBLE) {
+		value.d = std::numeric_limits<double>::quiet_NaN();
+	}
+	else {
+		value.i = 0;
+	}
+	return value;
+}
+
+char *format_reading(char *out, ChannelValue value, const ChannelSpec &spec) {
+	char *end = out + MAX_READING_CHARS;
+
+	switch(spec.type) {
+	case ChannelType::INT32:
+		return std::to_chars(out, end, value.i).ptr;
+	case ChannelType::DOUBLE:
+		// the shortest representation that round-trips
+		return std::to_chars(out, end, value.d).ptr;
+	case ChannelType::FIXED: {
+		int64_t raw = value.i;
+		if(raw < 0) {
+			*out++ = '-';
+			raw = -raw;
+		}
+		int64_t scale = powers_of_ten[spec.decimals];
+		out = std::to_chars(out, end, raw / scale).ptr;
+		if(spec.decimals > 0) {
+			*out++ = '.';
+			int64_t fraction = raw % scale;
+			// zero-pad the fractional part
+			for(int64_t digit = scale / 10; digit > 0; digit /= 10) {
+				*out++ = '0' + (fraction / digit) % 10;
+			}
+		}
+		return out;
+	}
+	}
+
+	return out;
+}
+
+void append_readings(std::string &out, const std::vector<ChannelValue> &values, const ChannelSchema &schema) {
+	char buffer[MAX_READING_CHARS];
+	for(std::size_t i = 0; i < values.size(); i++) {
+		char *end = format_reading(buffer, values[i], schema[i]);
+		out += ' ';
+		out.append(buffer, end - buffer);
+	}
+}
+
+int64_t serial_reading(ChannelValue value, const ChannelSpec &spec) {
+	if(spec.type == ChannelType::DOUBLE) {
+		double scaled = value.d * powers_of_ten[SERIAL_DECIMALS];
+		if(std::isnan(scaled)) {
+			return 0;
+		}
+		// saturate instead of overflowing
+		scaled = std::max(std::min(scaled, 9.2e18), -9.2e18);
+		return std::llround(scaled);
+	}
+	return value.i;
+}
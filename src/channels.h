@@ -0,0 +1,120 @@
+/*
+ * channels.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef CHANNELS_H_
+#define CHANNELS_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * The native type of the readings of a channel.
+ */
+enum class ChannelType : uint8_t {
+	INT32, DOUBLE, FIXED
+};
+
+struct ChannelSpec {
+	ChannelType type = ChannelType::INT32;
+	/// the number of decimal digits of fixed-point readings
+	int decimals = 0;
+};
+
+/**
+ * A reading. Its interpretation depends on the ChannelSpec of its channel: integer readings are stored in i,
+ * fixed-point ones are stored in i multiplied by 10^decimals, and floating-point ones in d.
+ */
+union ChannelValue {
+	int32_t i;
+	double d;
+};
+
+/// a channel mask that selects all the channels
+constexpr uint64_t ALL_CHANNELS = ~0ull;
+
+/**
+ * Return true if the given channel is selected by the mask. Channels beyond the 64th can be selected only by ALL_CHANNELS.
+ */
+inline bool channel_selected(uint64_t channel_mask, std::size_t channel) {
+	return (channel < 64) ? (channel_mask >> channel) & 1 : channel_mask == ALL_CHANNELS;
+}
+
+/// the maximum number of decimal digits of fixed-point channels
+constexpr int MAX_DECIMALS = 9;
+
+/// the number of decimal digits used to send floating-point readings over the serial line
+constexpr int SERIAL_DECIMALS = 3;
+
+/// the maximum number of characters format_reading writes
+constexpr int MAX_READING_CHARS = 32;
+
+/**
+ * The types of the channels of a device. If there are more channels than specs, the last spec applies to the
+ * remaining channels.
+ */
+class ChannelSchema {
+public:
+	ChannelSchema();
+
+	/**
+	 * Build a schema from the given specs, which should not be empty.
+	 */
+	ChannelSchema(std::vector<ChannelSpec> specs);
+
+	/**
+	 * Build a schema from a comma-separated list of types, each of which can be "int", "double" or "fixedN", where
+	 * N is the number of decimal digits (e.g. "int,fixed2,double"). Throws std::invalid_argument on error.
+	 */
+	static ChannelSchema parse(const std::string &source);
+
+	const ChannelSpec &operator[](std::size_t channel) const {
+		return (channel < _specs.size()) ? _specs[channel] : _specs.back();
+	}
+
+	/**
+	 * Return the schema of the readings that are left once the channels that are not selected by the mask have
+	 * been dropped.
+	 */
+	ChannelSchema select(uint64_t channel_mask) const;
+
+private:
+	std::vector<ChannelSpec> _specs;
+};
+
+/**
+ * Convert a field to a reading of the given type.
+ *
+ * @return false if the field does not contain a valid reading
+ */
+bool convert_reading(std::string_view field, const ChannelSpec &spec, ChannelValue &value);
+
+/**
+ * Return the value stored in place of the readings that cannot be parsed.
+ */
+ChannelValue bad_reading(const ChannelSpec &spec);
+
+/**
+ * Write the textual representation of a reading into the given buffer, which must be at least MAX_READING_CHARS long.
+ *
+ * @return a pointer past the last character written
+ */
+char *format_reading(char *out, ChannelValue value, const ChannelSpec &spec);
+
+/**
+ * Append the readings to the given string, each preceded by a space.
+ */
+void append_readings(std::string &out, const std::vector<ChannelValue> &values, const ChannelSchema &schema);
+
+/**
+ * Return the reading as a (possibly scaled) integer suitable for the serial line: integer and fixed-point readings
+ * are returned as they are stored, floating-point ones are converted to fixed-point with SERIAL_DECIMALS digits.
+ */
+int64_t serial_reading(ChannelValue value, const ChannelSpec &spec);
+
+#endif /* CHANNELS_H_ */
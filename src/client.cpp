@@ -2,229 +2,661 @@
 #include <chrono>
 #include <ctime>
 #include <cstdlib>
-#include <iomanip>
 #include <thread>
-#include <asio.hpp>
+#include <csignal>
 #include <RS-232/rs232.h>
 #include <tclap/CmdLine.h>
 
+#include "AsioSerialWriter.h"
+#include "DeviceConfig.h"
+#include "parser.h"
+#include "RateController.h"
+#include "SampleBlock.h"
+#include "SerialCoalescer.h"
+#include "SerialWriter.h"
+#include "ShardedExecutor.h"
+#include "Sinks.h"
 #include "strings.h"
+#include "TCPClient.h"
+#include "TimeFormatter.h"
 
-using namespace asio;
-using ip::tcp;
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
 
-class TCPClient {
-public:
-	TCPClient(std::string raw_ip_address, unsigned short port);
+// cleared by SIGINT and SIGTERM to stop the synchronous polling loop, so that the buffered output is not lost
+volatile std::sig_atomic_t keep_polling = 1;
 
-	void connect();
-	void connect_dummy();
-	std::string read();
-	void write(const std::string &message);
+void stop_polling(int) {
+	keep_polling = 0;
+}
 
-	uint64_t last_write_time();
-	uint64_t last_read_time();
-private:
-	uint64_t _time();
-	uint64_t _creation_time;
-	uint64_t _last_write_time;
-	uint64_t _last_read_time;
-	asio::error_code _error;
-	asio::io_service _io_service;
-	tcp::endpoint _endpoint;
-	tcp::socket _socket;
-	bool _is_dummy = false;
-};
+/**
+ * Counters of the samples received from a device.
+ */
+struct DeviceStats {
+	uint64_t samples = 0;
+	/// samples that have been discarded because some of their readings could not be parsed
+	uint64_t bad_samples = 0;
+	uint64_t bad_readings = 0;
+
+	/**
+	 * Account for a sample with the given number of bad readings and return true if the sample should be kept.
+	 */
+	bool add(std::size_t n_bad) {
+		samples++;
+		if(n_bad > 0) {
+			bad_samples++;
+			bad_readings += n_bad;
+			return false;
+		}
+		return true;
+	}
 
-TCPClient::TCPClient(std::string raw_ip_address, unsigned short port) : _socket(_io_service) {
-	_creation_time = _time();
-	_last_write_time = _creation_time;
+	/**
+	 * Account for the lines that have been discarded before parsing, because they were too long.
+	 */
+	void add_discarded(uint64_t n_lines) {
+		samples += n_lines;
+		bad_samples += n_lines;
+	}
 
-	asio::ip::address ip_address = asio::ip::address::from_string(raw_ip_address, _error);
-	if(_error.value() != 0) {
-		// Provided IP address is invalid. Breaking execution.
-		std::cerr
-				<< "Failed to parse the IP address. Error code = "
-				<< _error.value() << ". Message: " << _error.message() << std::endl;;
-		exit(1);
+	void print(std::ostream &out, const std::string &tag) const {
+		out << tag << ", samples: " << samples << ", discarded: " << bad_samples << " (" << bad_readings << " bad readings)" << std::endl;
 	}
+};
 
-	_endpoint.address(asio::ip::address::from_string(raw_ip_address));
-	_endpoint.port(port);
+/**
+ * Append the line sent to the serial port for the given sample. The serial line carries integers only, hence
+ * floating-point readings are sent as fixed-point ones.
+ */
+void append_serial_line(std::string &out, const Sample &sample) {
+	if(sample.device_id >= 0) {
+		utils::append_number(out, sample.device_id);
+		out += ' ';
+	}
+	utils::append_number(out, sample.values.size());
+	out += ' ';
+	for(std::size_t i = 0; i < sample.values.size(); i++) {
+		out += ' ';
+		utils::append_number(out, serial_reading(sample.values[i], (*sample.schema)[i]));
+	}
+	out += '\n';
 }
 
-uint64_t TCPClient::_time() {
-	auto time = std::chrono::high_resolution_clock::now().time_since_epoch();
-	return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
-}
+/**
+ * Sends the readings to a serial port. If a SerialCoalescer is given, the frames are kept within the budget of the
+ * line and the samples that arrive while it is busy are merged into the next frame. The frames are then sent by a
+ * thread of the sink as soon as the line has room for them, so that the merged samples of a device that has gone
+ * quiet are not held back.
+ */
+class SerialSink: public Sink {
+public:
+	SerialSink(const std::string &name, std::unique_ptr<SerialCoalescer> coalescer) :
+					Sink(name),
+					_coalescer(std::move(coalescer)) {
+		if(_coalescer) {
+			_thread = std::thread([this]() {
+				_send_frames();
+			});
+		}
+	}
 
-void TCPClient::connect() {
-	_socket.connect(_endpoint, _error);
-	if(_error.value() != 0) {
-		// Failed to open the socket.
-		std::cerr
-				<< "Failed to open the socket! Error code = "
-				<< _error.value() << ". Message: " << _error.message() << std::endl;;
-		exit(1);
+	virtual ~SerialSink() {
+		_stop_thread();
 	}
-}
 
-void TCPClient::connect_dummy() {
-	_is_dummy = true;
+	void write(const Sample &sample) override {
+		if(_coalescer) {
+			_coalescer->add(sample);
+			// the thread is woken up only if it has nothing to send, otherwise it is waiting for the line anyway
+			bool wake;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				wake = _idle;
+				_idle = false;
+			}
+			if(wake) {
+				_cv.notify_one();
+			}
+			return;
+		}
 
-	std::srand(std::time(NULL));
-}
+		// the sink may be written by several polling threads
+		thread_local std::string line;
+		line.clear();
+		append_serial_line(line, sample);
+		_send(line);
+	}
 
-std::string TCPClient::read() {
-	_last_read_time = _time();
+	void close() override {
+		if(_coalescer) {
+			_stop_thread();
+			// the merged samples that are still waiting for the line
+			Sample frame;
+			std::string line;
+			for(std::size_t slot = 0; slot < _coalescer->n_devices(); slot++) {
+				if(_coalescer->take(slot, frame)) {
+					line.clear();
+					append_serial_line(line, frame);
+					_send(line);
+				}
+			}
+		}
+		_close();
+	}
 
-	if(_is_dummy) {
-		std::stringstream ss;
-		ss << std::rand() % 1024;
-		for(int i = 0; i < 8; i++) {
-			ss << "," << std::rand() % 1024;
+	void print_stats(std::ostream &out) const override {
+		if(_coalescer) {
+			_coalescer->print_stats(out);
 		}
-		return ss.str();
+		_print_port_stats(out);
 	}
 
-	asio::streambuf buf;
-	asio::read_until(_socket, buf, "\n");
-	std::string data = asio::buffer_cast<const char*>(buf.data());
-	// remove the last character, which is an \n
-	data.pop_back();
-	return data;
-}
+protected:
+	virtual void _send(std::string_view line) = 0;
+	virtual void _close() {}
+	virtual void _print_port_stats(std::ostream &out) const = 0;
+
+private:
+	void _send_frames() {
+		Sample frame;
+		std::string line;
+		std::unique_lock<std::mutex> lock(_mutex);
+		while(!_stop) {
+			// set before looking for frames, so that a sample added meanwhile wakes this thread up
+			_idle = true;
+			lock.unlock();
+			std::chrono::steady_clock::duration wait;
+			while(_coalescer->next(frame, wait)) {
+				line.clear();
+				append_serial_line(line, frame);
+				_send(line);
+				_coalescer->sent(line.size());
+			}
+			lock.lock();
+
+			if(wait == std::chrono::steady_clock::duration::max()) {
+				_cv.wait(lock, [this]() {
+					return _stop || !_idle;
+				});
+			}
+			else {
+				_cv.wait_for(lock, wait, [this]() {
+					return _stop;
+				});
+			}
+		}
+	}
 
-void TCPClient::write(const std::string &message) {
-	_last_write_time = _time();
+	void _stop_thread() {
+		if(!_thread.joinable()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		_cv.notify_one();
+		_thread.join();
+	}
+
+	std::unique_ptr<SerialCoalescer> _coalescer;
+	// wakes up the thread that sends the frames
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _idle = false;
+	bool _stop = false;
+	std::thread _thread;
+};
+
+/**
+ * Writes the lines to a port opened by RS232_OpenComport, one write(2) per line.
+ */
+class RS232SerialSink: public SerialSink {
+public:
+	RS232SerialSink(int com_port_number, std::unique_ptr<SerialCoalescer> coalescer) :
+					SerialSink("serial", std::move(coalescer)),
+					_writer(RS232_GetFd(com_port_number)) {
 
-	if(!_is_dummy) {
-		asio::write(_socket, asio::buffer(message + "\r\n"));
 	}
-}
 
-uint64_t TCPClient::last_write_time() {
-	return _last_write_time - _creation_time;
-}
+protected:
+	void _send(std::string_view line) override {
+		_writer.write(line);
+	}
 
-uint64_t TCPClient::last_read_time() {
-	return _last_read_time - _creation_time;
-}
+	void _print_port_stats(std::ostream &out) const override {
+		out << "Serial port, bytes queued: " << _writer.queued() << ", sent: " << _writer.sent() << ", dropped: " << _writer.dropped() << " (" << _writer.dropped_frames() << " lines dropped, " << _writer.truncated_frames() << " truncated)" << std::endl;
+	}
 
-std::vector<int> parse_message(const std::string &message) {
-	auto spl = utils::split(message, ",");
-	std::vector<int> results(spl.size() / 3);
-	for(int i = 0; i < spl.size() / 3; i++) {
-		results[i] = utils::lexical_cast<int>(spl[2 * i + 2]);
+private:
+	SerialWriter _writer;
+};
+
+/**
+ * Writes the lines to a serial port with asynchronous writes issued by an event loop of its own. Lines are queued
+ * directly by the polling threads, and those queued while a write is in progress are sent together by the next one.
+ */
+class AsioSerialSink: public SerialSink {
+public:
+	AsioSerialSink(const std::string &device, unsigned int baud_rate, const std::string &mode, std::size_t queue_size, std::unique_ptr<SerialCoalescer> coalescer) :
+					SerialSink("serial " + device, std::move(coalescer)),
+					_work(asio::make_work_guard(_io_context)),
+					_writer(_io_context, device, baud_rate, mode, queue_size) {
+		_thread = std::thread([this]() {
+			_io_context.run();
+		});
 	}
 
-	return results;
-}
+	virtual ~AsioSerialSink() {
+		_close();
+	}
 
-std::string current_time() {
-	auto now = std::chrono::system_clock::now();
-	auto in_time_t = std::chrono::system_clock::to_time_t(now);
-	auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) -
-			std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch());
+protected:
+	void _send(std::string_view line) override {
+		_writer.write(line);
+	}
 
-	std::stringstream ss;
-	ss << std::put_time(std::localtime(&in_time_t), "%T") << "." << std::setfill('0') << std::setw(3) << ms.count();
-	return ss.str();
-}
+	void _close() override {
+		if(_thread.joinable()) {
+			_writer.close();
+			_work.reset();
+			_thread.join();
+		}
+	}
+
+	void _print_port_stats(std::ostream &out) const override {
+		out << "Serial port, lines queued: " << _writer.queued() << ", dropped: " << _writer.dropped() << ", bytes sent: " << _writer.bytes_sent() << " in " << _writer.n_writes() << " writes" << std::endl;
+	}
+
+private:
+	asio::io_context _io_context;
+	asio::executor_work_guard<asio::io_context::executor_type> _work;
+	AsioSerialWriter _writer;
+	std::thread _thread;
+};
 
 int main(int argc, char *argv[]) {
 	try {
 		TCLAP::CmdLine cmd("PADL - Polling Asincrono di DL", ' ', "0.1");
 
-		TCLAP::UnlabeledValueArg<std::string> ip_arg("ip", "The IP address of the DL device", true, "127.0.0.1", "an IP address (e.g. 192.168.0.1)");
-		TCLAP::UnlabeledValueArg<int> port_arg("port", "The TCP port of the DL device", true, 6000, "a port number (e.g. 6000)");
+		TCLAP::UnlabeledMultiArg<std::string> device_arg("devices", "The DL devices to be polled, each given either as an IP address followed by a TCP port or as [tag=]ip:port", false, "an IP address and a port number (e.g. 192.168.0.1 6000)");
+		TCLAP::ValueArg<std::string> device_file_arg("", "device-file", "A file containing the list of DL devices to be polled, one 'tag ip port [milliseconds]' per line", false, "", "filename");
 
 		TCLAP::SwitchArg dummy_arg("d", "dummy", "Generate synthetic data", false);
 
-		TCLAP::ValueArg<int> ms_arg("s", "sleep", "Sleeping time between sendings (in milliseconds)", false, 0, "milliseconds");
+		TCLAP::ValueArg<int> ms_arg("s", "sleep", "Polling period (in milliseconds). If 0, the device is polled as fast as possible", false, 0, "milliseconds");
+
+		TCLAP::ValueArg<unsigned int> pipeline_arg("", "pipeline", "Poll the device asynchronously, keeping up to this many requests in flight (0 means synchronous polling)", false, 0, "depth");
+
+		TCLAP::ValueArg<std::string> stream_arg("", "stream", "Send this command once and then read the readings continuously pushed by the device", false, "", "start command");
+
+		TCLAP::SwitchArg kernel_ts_arg("k", "kernel-timestamps", "Use the kernel timestamps of the requests and responses, and print the timing uncertainty of each sample (Linux only)", false);
+
+		TCLAP::ValueArg<double> adaptive_arg("a", "adaptive", "Adapt the polling period of each device to poll it as fast as possible while keeping its mean round-trip time below this target (in milliseconds)", false, 0., "milliseconds");
+
+		TCLAP::ValueArg<std::string> layout_arg("l", "layout", "Layout of the device response: 'dl' or STRIDE:OFFSET:N_CHANNELS (e.g. 3:2:8), defaults to dl", false, "dl", "layout");
+		TCLAP::ValueArg<std::string> channels_arg("c", "channels", "Comma-separated list of the channels to be read (e.g. 0,2,5), defaults to all", false, "", "channels");
+		TCLAP::ValueArg<std::string> types_arg("", "types", "Comma-separated list of the types of the channels, each of which can be int, double or fixedN, with N the number of decimal digits (e.g. int,fixed2,double). The last type applies to the remaining channels, defaults to int", false, "int", "types");
+
+		TCLAP::ValueArg<unsigned int> threads_arg("t", "threads", "Number of threads the devices are spread across (0 means one per core)", false, 1, "threads");
+		TCLAP::SwitchArg pin_arg("", "pin-threads", "Pin each polling thread to its own core (Linux only)", false);
+
+		std::vector<std::string> allowed_formats = {"text", "binary"};
+		TCLAP::ValuesConstraint<std::string> format_constraint(allowed_formats);
+		TCLAP::ValueArg<std::string> format_arg("f", "format", "Format of the output written to the standard output, files and sockets: text or binary (see bin2text), defaults to text", false, "text", &format_constraint);
+		TCLAP::ValueArg<std::string> time_format_arg("", "time-format", "Format of the current_time column: clock (HH:MM:SS.mmm, local time), iso8601 (local time, with microseconds and UTC offset), epoch-ns (nanoseconds since the Unix epoch) or relative (microseconds since the client was started), defaults to clock", false, "clock", "format");
+		TCLAP::MultiArg<std::string> sink_arg("", "sink", "An output the samples are sent to, given as KIND[:TARGET][,every=N][,format=text|binary][,queue=N][,overflow=block|drop], where KIND is stdout, serial (see -p), file:PATH, tcp:HOST:PORT, ring:PATH, record:PATH or shm:NAME. Each sink receives one sample out of every N of each device and is written by its own thread. When its queue is full, serial and tcp sinks drop samples while the other ones block the polling, unless overflow is given. Can be given multiple times, defaults to serial if -p is given and to stdout otherwise", false, "sink");
+		TCLAP::ValueArg<std::string> ring_arg("", "ring", "Also write the text lines to a memory-mapped ring log with this path (e.g. /dev/shm/padl.ring), which other processes can read with ringtail. Same as --sink ring:PATH", false, "", "filename");
+		TCLAP::ValueArg<uint64_t> ring_slots_arg("", "ring-slots", "Number of lines the ring log can hold, defaults to 65536", false, 65536, "lines");
+		TCLAP::ValueArg<std::string> record_arg("", "record", "Also record the samples to this file, in a compressed columnar format that can be converted to text with rec2text. Same as --sink record:PATH", false, "", "filename");
+		TCLAP::ValueArg<std::string> shm_arg("", "shm", "Also publish the latest samples of each device in a shared-memory object with this name (e.g. padl), which other processes can read with shmcat or SharedSamplesReader. Same as --sink shm:NAME", false, "", "name");
+		TCLAP::ValueArg<uint64_t> shm_history_arg("", "shm-history", "Number of samples of each device kept in the shared-memory object, defaults to 64", false, 64, "samples");
+		TCLAP::ValueArg<int> flush_arg("", "flush-latency", "Maximum time the output written to the standard output, files and sockets can be kept in the buffer (in milliseconds). Lines are never buffered if the standard output is a terminal", false, 50, "milliseconds");
 
 		TCLAP::ValueArg<int> com_port_arg("p", "serial-port", "The COM port number of the serial port to which the output will be printed", false, -1, "COM port number (e.g. 0)");
 		TCLAP::ValueArg<int> baud_rate_arg("b", "baudrate", "Baudrate of the serial connection, defaults to 9600", false, 9600, "bauds");
 		TCLAP::ValueArg<std::string> mode_arg("", "mode", "Mode of the serial connection, defaults to 8N1", false, "8N1", "serial mode");
+		std::vector<std::string> allowed_backends = {"rs232", "asio"};
+		TCLAP::ValuesConstraint<std::string> backend_constraint(allowed_backends);
+		TCLAP::ValueArg<std::string> serial_backend_arg("", "serial-backend", "How lines are written to the serial port: rs232 (by the thread of the serial sink, waiting for the port when its buffer is full) or asio (queued by the polling threads and written asynchronously by an event loop), defaults to rs232", false, "rs232", &backend_constraint);
+		TCLAP::ValueArg<std::string> coalesce_arg("", "serial-coalesce", "What to send when the device is polled faster than the serial line, given the baud rate and the mode, can carry the lines: latest (the newest sample), min, max or mean (the smallest, largest or average reading of each channel since the last line), or off (send every sample, waiting for the port), defaults to latest", false, "latest", "mode");
 
-		cmd.add(ip_arg);
-		cmd.add(port_arg);
+		cmd.add(device_arg);
+		cmd.add(device_file_arg);
 		cmd.add(dummy_arg);
 		cmd.add(ms_arg);
+		cmd.add(pipeline_arg);
+		cmd.add(stream_arg);
+		cmd.add(kernel_ts_arg);
+		cmd.add(adaptive_arg);
+		cmd.add(layout_arg);
+		cmd.add(channels_arg);
+		cmd.add(types_arg);
+		cmd.add(threads_arg);
+		cmd.add(pin_arg);
+		cmd.add(format_arg);
+		cmd.add(time_format_arg);
+		cmd.add(sink_arg);
+		cmd.add(ring_arg);
+		cmd.add(ring_slots_arg);
+		cmd.add(record_arg);
+		cmd.add(shm_arg);
+		cmd.add(shm_history_arg);
+		cmd.add(flush_arg);
 		cmd.add(com_port_arg);
 		cmd.add(baud_rate_arg);
 		cmd.add(mode_arg);
+		cmd.add(serial_backend_arg);
+		cmd.add(coalesce_arg);
 
 		cmd.parse(argc, argv);
 
-		std::string raw_ip_address(ip_arg.getValue());
-		unsigned short port_num = port_arg.getValue();
 		bool dummy = dummy_arg.getValue();
 
 		auto sleep_duration = std::chrono::milliseconds(ms_arg.getValue());
+		unsigned int pipeline_depth = pipeline_arg.getValue();
+		bool streaming = stream_arg.isSet();
+		bool kernel_timestamps = kernel_ts_arg.getValue();
+		bool adaptive = adaptive_arg.isSet();
+
+		LayoutParser parser;
+		uint64_t channel_mask = ALL_CHANNELS;
+		ChannelSchema schema;
+		TimeFormatter time_formatter;
+		std::vector<SinkSpec> sink_specs;
+		try {
+			parser = layout_parser(layout_arg.getValue());
+			if(channels_arg.isSet()) {
+				channel_mask = parse_channel_mask(channels_arg.getValue());
+			}
+			schema = ChannelSchema::parse(types_arg.getValue());
+			time_formatter = TimeFormatter(TimeFormatter::parse_format(time_format_arg.getValue()));
+			for(auto &description : sink_arg.getValue()) {
+				sink_specs.push_back(SinkSpec::parse(description));
+			}
+		}
+		catch(std::invalid_argument &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		// the types of the readings that are left after the channel selection
+		ChannelSchema output_schema = schema.select(channel_mask);
+
+		std::vector<DeviceConfig> devices;
+		try {
+			auto &endpoints = device_arg.getValue();
+			for(uint i = 0; i < endpoints.size(); i++) {
+				if(is_device_endpoint(endpoints[i])) {
+					devices.push_back(parse_device(endpoints[i], sleep_duration));
+				}
+				else if(i + 1 < endpoints.size()) {
+					devices.push_back(parse_device(endpoints[i], endpoints[i + 1], sleep_duration));
+					i++;
+				}
+				else {
+					throw bad_device_config("missing port number for device '" + endpoints[i] + "'");
+				}
+			}
+			if(device_file_arg.isSet()) {
+				auto from_file = load_device_file(device_file_arg.getValue(), sleep_duration);
+				devices.insert(devices.end(), from_file.begin(), from_file.end());
+			}
+		}
+		catch(bad_device_config &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
 
-		bool write_com = false;
-		int com_port_number = com_port_arg.getValue();
-		if(com_port_number >= 0) {
-			write_com = true;
-			int baud_rate = baud_rate_arg.getValue();
-			std::string mode = mode_arg.getValue();
-			// open the COM port
-			RS232_OpenComport(com_port_number, baud_rate, mode.c_str(), 0);
+		if(devices.size() == 0) {
+			std::cerr << "ERROR: no DL device given. Use either '<ip> <port>' or --device-file" << std::endl;
+			return 1;
 		}
 
-		TCPClient client(raw_ip_address, port_num);
+		if(flush_arg.getValue() < 0) {
+			std::cerr << "ERROR: the flush latency should be non-negative" << std::endl;
+			return 1;
+		}
+		auto flush_latency = std::chrono::milliseconds(flush_arg.getValue());
 
-		if(dummy) {
-			client.connect_dummy();
+		int com_port_number = com_port_arg.getValue();
+		if(sink_specs.empty()) {
+			sink_specs.push_back(SinkSpec::parse((com_port_number >= 0) ? "serial" : "stdout"));
 		}
-		else {
-			client.connect();
+		if(ring_arg.isSet()) {
+			sink_specs.push_back(SinkSpec::parse("ring:" + ring_arg.getValue()));
+		}
+		if(record_arg.isSet()) {
+			sink_specs.push_back(SinkSpec::parse("record:" + record_arg.getValue()));
+		}
+		if(shm_arg.isSet()) {
+			sink_specs.push_back(SinkSpec::parse("shm:" + shm_arg.getValue()));
 		}
 
-		while(true) {
-			std::string msg;
-			client.write("MS");
+		bool write_com = false;
+		SinkFanOut sinks(devices.size());
+		try {
+			for(auto &spec : sink_specs) {
+				bool binary = ((spec.format.empty()) ? format_arg.getValue() : spec.format) == "binary";
+				std::unique_ptr<Sink> sink;
+				if(spec.kind == "stdout") {
+					sink.reset(new StreamSink("stdout", STDOUT_FILENO, false, binary, devices.size(), time_formatter, flush_latency));
+				}
+				else if(spec.kind == "file") {
+					sink.reset(new StreamSink("file " + spec.target, open_sink_file(spec.target), true, binary, devices.size(), time_formatter, flush_latency));
+				}
+				else if(spec.kind == "tcp") {
+					sink.reset(new StreamSink("tcp " + spec.target, connect_sink_socket(spec.target), true, binary, devices.size(), time_formatter, flush_latency));
+				}
+				else if(spec.kind == "ring") {
+					sink.reset(new RingSink(spec.target, ring_slots_arg.getValue(), time_formatter));
+				}
+				else if(spec.kind == "record") {
+					sink.reset(new RecordSink(spec.target, devices.size()));
+				}
+				else if(spec.kind == "shm") {
+					// publishing a sample in shared memory costs less than queueing it
+					sinks.add_direct(std::unique_ptr<Sink>(new SharedSamplesSink(spec.target, devices.size(), shm_history_arg.getValue())), spec.every);
+					continue;
+				}
+				else if(spec.kind == "serial") {
+					if(com_port_number < 0) {
+						throw bad_sink("the serial sink requires a COM port (-p)");
+					}
+					// the line budget is shared by all the devices
+					std::unique_ptr<SerialCoalescer> coalescer;
+					if(coalesce_arg.getValue() != "off") {
+						try {
+							double bytes_per_second = SerialCoalescer::line_rate(baud_rate_arg.getValue(), SerialMode::parse(mode_arg.getValue()));
+							coalescer.reset(new SerialCoalescer(devices.size(), bytes_per_second, SerialCoalescer::parse_mode(coalesce_arg.getValue())));
+						}
+						catch(std::invalid_argument &e) {
+							throw bad_sink(e.what());
+						}
+					}
+
+					if(serial_backend_arg.getValue() == "asio") {
+						const char *port_name = RS232_GetPortName(com_port_number);
+						if(port_name == nullptr) {
+							throw bad_sink("illegal COM port " + std::to_string(com_port_number));
+						}
+						if(spec.overflow == SinkOverflow::BLOCK) {
+							throw bad_sink("the asio serial backend always drops the lines that do not fit in its queue");
+						}
+						sinks.add_direct(std::unique_ptr<Sink>(new AsioSerialSink(port_name, baud_rate_arg.getValue(), mode_arg.getValue(), spec.queue, std::move(coalescer))), spec.every);
+						continue;
+					}
+					if(!write_com) {
+						if(RS232_OpenComport(com_port_number, baud_rate_arg.getValue(), mode_arg.getValue().c_str(), 0) != 0) {
+							throw bad_sink("cannot open COM port " + std::to_string(com_port_number));
+						}
+						write_com = true;
+					}
+					sink.reset(new RS232SerialSink(com_port_number, std::move(coalescer)));
+				}
+				sinks.add(std::move(sink), spec.every, spec.queue, spec.overflow);
+			}
+		}
+		catch(std::runtime_error &e) {
+			// bad_sink, bad_ring_log, bad_recording, bad_shared_samples and bad_serial_port
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		// a socket sink whose listener goes away should not bring the client down
+		std::signal(SIGPIPE, SIG_IGN);
 
-			// getting response from server
-			asio::streambuf receive_buffer;
-			std::string message = client.read();
-			auto sensor_values = parse_message(message);
-			uint64_t average_time = (client.last_write_time() + client.last_read_time()) / 2;
+		// there is no point in having more shards than devices
+		unsigned int n_threads = threads_arg.getValue();
+		if(n_threads == 0) {
+			n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		ShardedExecutor executor(std::min<unsigned int>(n_threads, devices.size()), pin_arg.getValue());
 
-			if(write_com) {
-				uint n_values = sensor_values.size();
+		std::vector<std::unique_ptr<TCPClient>> clients;
+		for(auto &device : devices) {
+			clients.emplace_back(new TCPClient(executor.next_shard(), device.ip, device.port));
+			if(dummy) {
+				clients.back()->connect_dummy();
+			}
+			else {
+				clients.back()->connect();
+			}
 
-				std::stringstream ss;
-				ss << n_values << " ";
+			if(kernel_timestamps && !clients.back()->enable_kernel_timestamps()) {
+				std::cerr << "WARNING: kernel timestamps are not available for device " << device.tag << ", user-space timestamps will be used instead" << std::endl;
+			}
+		}
 
-				for(auto &value : sensor_values) {
-					ss << " " << value;
+		if(devices.size() == 1 && pipeline_depth == 0 && devices[0].interval.count() == 0 && !streaming && !kernel_timestamps && !adaptive) {
+			// poll as fast as possible, one request at a time
+			auto &client = *clients.front();
+			std::vector<ChannelValue> sensor_values;
+			DeviceStats stats;
+			std::signal(SIGINT, stop_polling);
+			std::signal(SIGTERM, stop_polling);
+			while(keep_polling) {
+				client.write("MS");
+
+				// getting response from server
+				uint64_t discarded = client.discarded_lines();
+				auto message = client.read();
+				if(client.discarded_lines() != discarded) {
+					continue;
+				}
+				if(!stats.add(parser(message, sensor_values, schema, channel_mask))) {
+					continue;
 				}
-				ss << '\n';
-				std::string output = ss.str();
+				uint64_t average_time = (client.last_write_time() + client.last_read_time()) / 2;
 
-				RS232_cputs(com_port_number, output.c_str());
+				sinks.publish(0, -1, devices[0].tag, sensor_values, output_schema, average_time, -1);
 			}
-			else {
-				std::stringstream ss;
-				ss << average_time << " " << current_time();
 
-				for(auto &value : sensor_values) {
-					ss << " " << value;
+			stats.add_discarded(client.discarded_lines());
+			stats.print(std::cerr, devices[0].tag);
+		}
+		else {
+			// the devices are polled asynchronously, each with its own schedule, from the event loops of the executor
+			bool tagged = devices.size() > 1;
+			std::vector<std::unique_ptr<RateController>> controllers(devices.size());
+			std::vector<DeviceStats> device_stats(devices.size());
+			std::vector<std::unique_ptr<BlockParser>> block_parsers(devices.size());
+			std::vector<std::unique_ptr<SampleBlock>> blocks(devices.size());
+			for(uint i = 0; i < devices.size(); i++) {
+				int device_id = (tagged) ? i : -1;
+				const std::string &tag = devices[i].tag;
+				auto interval = std::chrono::duration_cast<std::chrono::microseconds>(devices[i].interval);
+
+				if(adaptive && !streaming) {
+					// the controller needs a periodic schedule to act upon
+					if(interval.count() == 0) {
+						interval = std::chrono::milliseconds(100);
+					}
+					auto target = std::chrono::microseconds(static_cast<int64_t>(adaptive_arg.getValue() * 1000));
+					controllers[i].reset(new RateController(tag, target, interval, std::chrono::microseconds(100), std::chrono::seconds(10), &std::cerr));
 				}
-				std::string output = ss.str();
 
-				std::cout << output << std::endl;
+				TCPClient *client = clients[i].get();
+				RateController *controller = controllers[i].get();
+				DeviceStats *stats = &device_stats[i];
+				// the buffer the readings are parsed into, reused across samples
+				std::vector<ChannelValue> sensor_values;
+				auto handler = [i, device_id, &tag, client, controller, stats, parser, &schema, &output_schema, channel_mask, sensor_values, kernel_timestamps, &sinks](uint64_t write_time, uint64_t read_time, std::string_view message) mutable {
+					if(controller != nullptr) {
+						auto rtt = std::chrono::microseconds(read_time - write_time);
+						if(controller->add_sample(rtt, client->scheduler()->missed())) {
+							client->set_interval(controller->period());
+						}
+					}
+
+					if(!stats->add(parser(message, sensor_values, schema, channel_mask))) {
+						return;
+					}
+					uint64_t average_time = (write_time + read_time) / 2;
+					// the device took the sample somewhere between the two timestamps
+					int64_t uncertainty = (kernel_timestamps) ? (read_time - write_time) / 2 : -1;
+					sinks.publish(i, device_id, tag, sensor_values, output_schema, average_time, uncertainty);
+				};
+
+				if(streaming) {
+					// the lines received in a burst are parsed in a single pass into a columnar block
+					block_parsers[i].reset(new BlockParser(parser, schema, channel_mask));
+					blocks[i].reset(new SampleBlock());
+					BlockParser *block_parser = block_parsers[i].get();
+					SampleBlock *block = blocks[i].get();
+					auto block_handler = [i, device_id, &tag, stats, block_parser, block, &output_schema, &sinks](uint64_t read_time, std::string_view lines) mutable {
+						while(!lines.empty()) {
+							block->clear();
+							std::size_t consumed = block_parser->parse(lines, read_time, *block);
+							if(consumed == 0) {
+								break;
+							}
+							lines.remove_prefix(consumed);
+
+							// streamed readings are not requested, hence there is no interval to derive an uncertainty from
+							int64_t uncertainty = -1;
+							sinks.publish_block(i, device_id, tag, *block, output_schema, uncertainty);
+						}
+
+						stats->samples = block_parser->samples();
+						stats->bad_samples = block_parser->bad_samples();
+						stats->bad_readings = block_parser->bad_readings();
+					};
+					clients[i]->start_streaming_blocks(stream_arg.getValue(), block_handler);
+				}
+				else {
+					clients[i]->start_pipelined("MS", std::max(pipeline_depth, 1u), interval, handler);
+				}
 			}
 
-			std::this_thread::sleep_for(sleep_duration);
+			asio::signal_set signals(executor.shard(0), SIGINT, SIGTERM);
+			signals.async_wait([&executor](const asio::error_code &ec, int) {
+				if(!ec) {
+					executor.stop();
+				}
+			});
+
+			executor.run();
+
+			for(uint i = 0; i < devices.size(); i++) {
+				device_stats[i].add_discarded(clients[i]->discarded_lines());
+				device_stats[i].print(std::cerr, devices[i].tag);
+
+				auto scheduler = clients[i]->scheduler();
+				if(scheduler != nullptr) {
+					std::cerr << devices[i].tag << ", ";
+					scheduler->print_stats(std::cerr);
+				}
+			}
 		}
 
+		// the sinks are stopped only once they have written all the samples they have been given
+		sinks.stop();
+		sinks.print_stats(std::cerr);
 		if(write_com) {
 			RS232_CloseComport(com_port_number);
 		}
-
 	}
 	catch(TCLAP::ArgException &e) {
 		std::cerr << "ERROR: " << e.error() << " for arg " << e.argId() << std::endl;
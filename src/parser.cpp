@@ -0,0 +1,193 @@
+/*
+ * parser.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#include "parser.h"
+
+#include <stdexcept>
+
+namespace {
+
+template<std::size_t STRIDE, std::size_t OFFSET, std::size_t N_CHANNELS>
+std::size_t parse_fixed(std::string_view message, std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t channel_mask) {
+	typename FixedLayout<STRIDE, OFFSET, N_CHANNELS>::Values readings;
+	auto result = FixedLayout<STRIDE, OFFSET, N_CHANNELS>::parse(message, readings, schema, channel_mask);
+	values.assign(readings.begin(), readings.begin() + result.n_values);
+	return result.n_bad;
+}
+
+std::size_t parse_dl(std::string_view message, std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t channel_mask) {
+	return parse_message(message, values, schema, channel_mask);
+}
+
+// the maximum number of bad candidate readings parse_message keeps track of
+constexpr std::size_t MAX_TRACKED_BAD = 64;
+
+struct LayoutEntry {
+	const char *name;
+	LayoutParser parser;
+};
+
+// the layouts that are instantiated at compile time
+const LayoutEntry layouts[] = {
+	{"dl", parse_dl},
+	{"3:2:3", parse_fixed<3, 2, 3>},
+	{"3:2:4", parse_fixed<3, 2, 4>},
+	{"3:2:8", parse_fixed<3, 2, 8>},
+	{"3:2:16", parse_fixed<3, 2, 16>},
+	{"2:1:8", parse_fixed<2, 1, 8>},
+	{"2:1:16", parse_fixed<2, 1, 16>},
+	{"1:0:8", parse_fixed<1, 0, 8>},
+	{"1:0:16", parse_fixed<1, 0, 16>},
+	{"1:0:32", parse_fixed<1, 0, 32>},
+};
+
+}
+
+std::size_t parse_message(std::string_view message, std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t channel_mask) {
+	values.clear();
+
+	const char *ptr = message.data();
+	const char *end = ptr + message.size();
+	std::size_t n_fields = 0;
+	std::size_t channel = 0;
+	// the number of readings is known only at the end, so we convert all the candidates and then drop the extra ones.
+	// Only the bad readings that are kept should be counted, hence we store the channels of the bad candidates
+	std::array<std::size_t, MAX_TRACKED_BAD> bad_channels;
+	std::size_t n_bad_candidates = 0;
+	// the channels of the bad candidates that do not fit in bad_channels, which is rarely needed
+	thread_local std::vector<std::size_t> more_bad_channels;
+
+	while(true) {
+		auto field_end = static_cast<const char*>(std::memchr(ptr, ',', end - ptr));
+		bool last = (field_end == nullptr);
+		if(last) {
+			field_end = end;
+		}
+
+		// empty fields are skipped, except for the last one (this mimics the behaviour of utils::split)
+		if(field_end > ptr || last) {
+			if(n_fields >= 2 && n_fields % 2 == 0) {
+				if(channel_selected(channel_mask, channel)) {
+					ChannelValue value;
+					const ChannelSpec &spec = schema[channel];
+					if(!convert_reading(std::string_view(ptr, field_end - ptr), spec, value)) {
+						value = bad_reading(spec);
+						if(n_bad_candidates < MAX_TRACKED_BAD) {
+							bad_channels[n_bad_candidates] = channel;
+						}
+						else {
+							if(n_bad_candidates == MAX_TRACKED_BAD) {
+								more_bad_channels.clear();
+							}
+							more_bad_channels.push_back(channel);
+						}
+						n_bad_candidates++;
+					}
+					values.push_back(value);
+				}
+				channel++;
+			}
+			n_fields++;
+		}
+
+		if(last) {
+			break;
+		}
+		ptr = field_end + 1;
+	}
+
+	std::size_t n_channels = n_fields / 3;
+	std::size_t n_bad = 0;
+	for(std::size_t i = 0; i < std::min(n_bad_candidates, MAX_TRACKED_BAD); i++) {
+		if(bad_channels[i] < n_channels) {
+			n_bad++;
+		}
+	}
+	if(n_bad_candidates > MAX_TRACKED_BAD) {
+		for(std::size_t bad_channel : more_bad_channels) {
+			if(bad_channel < n_channels) {
+				n_bad++;
+			}
+		}
+	}
+
+	// drop the readings of the candidate channels that lie beyond the last one
+	std::size_t n_values = values.size();
+	if(channel_mask == ALL_CHANNELS) {
+		n_values = n_channels;
+	}
+	else if(n_channels < 64) {
+		n_values = __builtin_popcountll(channel_mask & ((1ull << n_channels) - 1));
+	}
+	values.resize(std::min(n_values, values.size()));
+
+	return std::min(n_bad, values.size());
+}
+
+std::size_t parse_fields(std::string_view source, const utils::Token *tokens, std::size_t n_tokens, std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t channel_mask) {
+	values.clear();
+
+	// the readings are the even-indexed fields starting from the third one, and they are a third of the fields
+	std::size_t n_channels = n_tokens / 3;
+	std::size_t n_bad = 0;
+	for(std::size_t channel = 0; channel < n_channels; channel++) {
+		if(!channel_selected(channel_mask, channel)) {
+			continue;
+		}
+		ChannelValue value;
+		const ChannelSpec &spec = schema[channel];
+		if(!convert_reading(tokens[2 + 2 * channel].in(source), spec, value)) {
+			value = bad_reading(spec);
+			n_bad++;
+		}
+		values.push_back(value);
+	}
+
+	return n_bad;
+}
+
+LayoutParser layout_parser(const std::string &name) {
+	for(auto &layout : layouts) {
+		if(name == layout.name) {
+			return layout.parser;
+		}
+	}
+
+	std::string available;
+	for(auto &layout_name : available_layouts()) {
+		available += " " + layout_name;
+	}
+	throw std::invalid_argument("unknown layout '" + name + "'. Available layouts:" + available);
+}
+
+std::vector<std::string> available_layouts() {
+	std::vector<std::string> names;
+	for(auto &layout : layouts) {
+		names.push_back(layout.name);
+	}
+	return names;
+}
+
+uint64_t parse_channel_mask(const std::string &channels) {
+	uint64_t mask = 0;
+	for(auto &token : utils::split(channels, ", ")) {
+		int channel;
+		try {
+			channel = utils::lexical_cast<int>(token);
+		}
+		catch(utils::bad_lexical_cast &) {
+			throw std::invalid_argument("invalid channel '" + token + "'");
+		}
+
+		if(channel < 0 || channel >= 64) {
+			throw std::invalid_argument("channel " + token + " is out of range (0-63)");
+		}
+		mask |= 1ull << channel;
+	}
+
+	return mask;
+}
@@ -0,0 +1,175 @@
+/*
+ * parser.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: lorenzo
+ */
+
+#ifndef PARSER_H_
+#define PARSER_H_
+
+#include "channels.h"
+#include "strings.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Parse the response of a DL device to a "MS" request. The response is a comma-separated list of fields, and the
+ * readings are the even-indexed fields starting from the third one. The number of readings is a third of the number
+ * of fields. Empty fields are ignored.
+ *
+ * The message is scanned only once and no memory is allocated, provided that values has enough capacity to store
+ * all the readings. Readings that cannot be converted are set to bad_reading() and counted.
+ *
+ * @param message the response, without the trailing newline
+ * @param values the vector the selected readings will be stored in. Its previous content is discarded
+ * @param schema the types of the channels
+ * @param channel_mask the channels to be converted and stored. The others are skipped
+ * @return the number of selected readings that could not be converted
+ */
+std::size_t parse_message(std::string_view message, std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t channel_mask=ALL_CHANNELS);
+
+/**
+ * Parse a response that has already been split into fields (e.g. by utils::tokenize_lines), with the same rules as
+ * parse_message. Since the number of fields, and hence of readings, is known in advance, only the readings that are
+ * kept are converted.
+ *
+ * @param source the string the offsets of the tokens refer to
+ * @param tokens the fields of the response
+ * @param n_tokens the number of fields
+ * @param values the vector the selected readings will be stored in. Its previous content is discarded
+ * @param schema the types of the channels
+ * @param channel_mask the channels to be converted and stored. The others are skipped
+ * @return the number of selected readings that could not be converted
+ */
+std::size_t parse_fields(std::string_view source, const utils::Token *tokens, std::size_t n_tokens, std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t channel_mask=ALL_CHANNELS);
+
+namespace parser_detail {
+
+/**
+ * Iterates over the non-empty comma-separated fields of a message.
+ */
+struct FieldCursor {
+	const char *ptr;
+	const char *end;
+
+	FieldCursor(std::string_view message) :
+					ptr(message.data()),
+					end(message.data() + message.size()) {
+
+	}
+
+	/**
+	 * Move to the next field.
+	 *
+	 * @return false if there are no more fields
+	 */
+	inline bool next(const char *&field_begin, const char *&field_end) {
+		while(ptr < end && *ptr == ',') {
+			ptr++;
+		}
+		if(ptr >= end) {
+			return false;
+		}
+
+		field_begin = ptr;
+		field_end = static_cast<const char*>(std::memchr(ptr, ',', end - ptr));
+		if(field_end == nullptr) {
+			field_end = end;
+		}
+		ptr = field_end;
+
+		return true;
+	}
+};
+
+}
+
+/**
+ * A response layout made of a fixed number of channels, the i-th of which is stored in the field OFFSET + i * STRIDE.
+ * Since the layout is known at compile time, the parser never looks past the last field it needs and the output
+ * has a fixed size.
+ */
+template<std::size_t STRIDE, std::size_t OFFSET, std::size_t N_CHANNELS>
+struct FixedLayout {
+	static_assert(STRIDE > 0 && N_CHANNELS > 0, "A layout should have a non-zero stride and at least one channel");
+
+	using Values = std::array<ChannelValue, N_CHANNELS>;
+
+	struct Result {
+		/// the number of readings stored
+		std::size_t n_values;
+		/// the number of readings that are missing or could not be converted
+		std::size_t n_bad;
+	};
+
+	/**
+	 * Parse a message. Readings that are missing (because the message is too short) or that cannot be converted
+	 * are set to bad_reading() and counted.
+	 *
+	 * @param message
+	 * @param values the array the selected readings will be stored in
+	 * @param schema the types of the channels
+	 * @param channel_mask the channels to be converted and stored
+	 * @return the number of readings stored in values and the number of bad ones
+	 */
+	static Result parse(std::string_view message, Values &values, const ChannelSchema &schema, uint64_t channel_mask=ALL_CHANNELS) {
+		parser_detail::FieldCursor cursor(message);
+		const char *begin = nullptr, *end = nullptr;
+		Result result = {0, 0};
+		bool available = true;
+
+		// skip the leading fields
+		for(std::size_t i = 0; i < OFFSET; i++) {
+			available = available && cursor.next(begin, end);
+		}
+
+		for(std::size_t channel = 0; channel < N_CHANNELS; channel++) {
+			if(channel > 0) {
+				for(std::size_t i = 1; i < STRIDE; i++) {
+					available = available && cursor.next(begin, end);
+				}
+			}
+			available = available && cursor.next(begin, end);
+
+			if(channel_selected(channel_mask, channel)) {
+				ChannelValue &value = values[result.n_values++];
+				const ChannelSpec &spec = schema[channel];
+				if(!available || !convert_reading(std::string_view(begin, end - begin), spec, value)) {
+					value = bad_reading(spec);
+					result.n_bad++;
+				}
+			}
+		}
+
+		return result;
+	}
+};
+
+/**
+ * The signature of the parsers that can be selected at runtime. They return the number of bad readings.
+ */
+using LayoutParser = std::size_t (*)(std::string_view message, std::vector<ChannelValue> &values, const ChannelSchema &schema, uint64_t channel_mask);
+
+/**
+ * Return the parser for the layout with the given name. "dl" is the layout handled by parse_message, while the
+ * fixed layouts are named "STRIDE:OFFSET:N_CHANNELS". Throws std::invalid_argument if the layout is not available.
+ */
+LayoutParser layout_parser(const std::string &name);
+
+/**
+ * Return the names of the available layouts.
+ */
+std::vector<std::string> available_layouts();
+
+/**
+ * Parse a comma-separated list of channel indices (e.g. "0,2,5") into a mask. Throws std::invalid_argument on error.
+ */
+uint64_t parse_channel_mask(const std::string &channels);
+
+#endif /* PARSER_H_ */
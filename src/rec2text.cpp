@@ -0,0 +1,197 @@
+#include <iostream>
+#include <fstream>
+#include <tclap/CmdLine.h>
+
+#include "parser.h"
+#include "Recording.h"
+#include "strings.h"
+#include "TimeFormatter.h"
+
+namespace {
+
+const char *role_name(ColumnRole role) {
+	switch(role) {
+	case ColumnRole::DELTA_TIME:
+		return "delta_time";
+	case ColumnRole::EPOCH_NS:
+		return "epoch_ns";
+	case ColumnRole::UNCERTAINTY:
+		return "uncertainty";
+	default:
+		return "channel";
+	}
+}
+
+/**
+ * Print the statistics stored in the footer of the chunk, without decoding its columns.
+ */
+void print_summary(const RecordingChunk &chunk, uint64_t channel_mask) {
+	std::cout << "chunk: slot " << chunk.slot << ", tag '" << chunk.tag << "', " << chunk.n_samples << " samples, " << chunk.data.size() << " bytes" << std::endl;
+	std::size_t channel = 0;
+	for(auto &column : chunk.columns) {
+		if(column.role == ColumnRole::READINGS && !channel_selected(channel_mask, channel++)) {
+			continue;
+		}
+		std::cout << "  " << role_name(column.role);
+		if(column.role == ColumnRole::READINGS) {
+			std::cout << " " << channel - 1;
+		}
+		std::cout << ": " << column.size << " bytes, count " << column.count;
+		if(column.count == 0) {
+			std::cout << std::endl;
+			continue;
+		}
+		if(column.is_double()) {
+			std::cout << ", min " << column.min.d << ", max " << column.max.d << std::endl;
+		}
+		else if(column.spec.type == ChannelType::FIXED && column.role == ColumnRole::READINGS) {
+			std::string min, max;
+			append_readings(min, {ChannelValue{static_cast<int32_t>(column.min.i)}}, ChannelSchema({column.spec}));
+			append_readings(max, {ChannelValue{static_cast<int32_t>(column.max.i)}}, ChannelSchema({column.spec}));
+			std::cout << ", min" << min << ", max" << max << std::endl;
+		}
+		else {
+			std::cout << ", min " << column.min.i << ", max " << column.max.i << std::endl;
+		}
+	}
+}
+
+}
+
+/**
+ * Convert a recording written by "client --record" to the text format printed by the client.
+ */
+int main(int argc, char *argv[]) {
+	try {
+		TCLAP::CmdLine cmd("Convert PADL recordings to text", ' ', "0.1");
+
+		TCLAP::UnlabeledValueArg<std::string> input_arg("input", "The recording to be converted. If not given, the recording is read from the standard input", false, "", "filename");
+		TCLAP::ValueArg<std::string> time_format_arg("", "time-format", "Format of the current_time column: clock, iso8601, epoch-ns or relative (microseconds since the recording was started), defaults to clock", false, "clock", "format");
+		TCLAP::ValueArg<std::string> channels_arg("c", "channels", "Comma-separated list of the recorded channels to be printed (e.g. 0,2). Only the columns of these channels are decoded", false, "", "channels");
+		TCLAP::SwitchArg summary_arg("", "summary", "Print the number of samples and the minimum and maximum of each column of each chunk instead of the samples", false);
+
+		cmd.add(input_arg);
+		cmd.add(time_format_arg);
+		cmd.add(channels_arg);
+		cmd.add(summary_arg);
+
+		cmd.parse(argc, argv);
+
+		TimeFormat time_format;
+		uint64_t channel_mask = ALL_CHANNELS;
+		try {
+			time_format = TimeFormatter::parse_format(time_format_arg.getValue());
+			if(channels_arg.isSet()) {
+				channel_mask = parse_channel_mask(channels_arg.getValue());
+			}
+		}
+		catch(std::invalid_argument &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		TimeFormatter formatter(time_format);
+
+		std::ifstream input_file;
+		if(input_arg.isSet()) {
+			input_file.open(input_arg.getValue(), std::ios::binary);
+			if(!input_file) {
+				std::cerr << "ERROR: cannot open '" << input_arg.getValue() << "'" << std::endl;
+				return 1;
+			}
+		}
+		std::istream &input = (input_arg.isSet()) ? input_file : std::cin;
+
+		try {
+			RecordingReader reader(input);
+			RecordingChunk chunk;
+			std::vector<int64_t> delta_times, epochs, uncertainties;
+			// the decoded columns of the selected channels
+			std::vector<std::vector<int64_t>> int_columns;
+			std::vector<std::vector<double>> double_columns;
+			std::vector<ChannelSpec> specs;
+			std::vector<ChannelValue> values;
+			std::string line;
+			while(reader.next(chunk)) {
+				if(summary_arg.getValue()) {
+					print_summary(chunk, channel_mask);
+					continue;
+				}
+
+				chunk.decode(chunk.find(ColumnRole::DELTA_TIME), delta_times);
+				chunk.decode(chunk.find(ColumnRole::EPOCH_NS), epochs);
+				int uncertainty_column = chunk.find(ColumnRole::UNCERTAINTY);
+				if(uncertainty_column >= 0) {
+					chunk.decode(uncertainty_column, uncertainties);
+				}
+
+				specs.clear();
+				std::size_t n_selected = 0;
+				for(std::size_t ch = 0; chunk.find(ColumnRole::READINGS, ch) >= 0; ch++) {
+					if(!channel_selected(channel_mask, ch)) {
+						continue;
+					}
+					std::size_t column = chunk.find(ColumnRole::READINGS, ch);
+					specs.push_back(chunk.columns[column].spec);
+					n_selected++;
+					if(int_columns.size() < n_selected) {
+						int_columns.resize(n_selected);
+						double_columns.resize(n_selected);
+					}
+					if(chunk.columns[column].is_double()) {
+						chunk.decode(column, double_columns[n_selected - 1]);
+					}
+					else {
+						chunk.decode(column, int_columns[n_selected - 1]);
+					}
+				}
+				ChannelSchema schema(specs);
+				values.resize(n_selected);
+
+				for(std::size_t s = 0; s < chunk.n_samples; s++) {
+					for(std::size_t i = 0; i < n_selected; i++) {
+						if(specs[i].type == ChannelType::DOUBLE) {
+							values[i].d = double_columns[i][s];
+						}
+						else {
+							values[i].i = static_cast<int32_t>(int_columns[i][s]);
+						}
+					}
+
+					line.clear();
+					if(chunk.device_id >= 0) {
+						line += chunk.tag;
+						line += ' ';
+					}
+					utils::append_number(line, static_cast<uint64_t>(delta_times[s]));
+					line += ' ';
+					if(uncertainty_column >= 0) {
+						utils::append_number(line, uncertainties[s]);
+						line += ' ';
+					}
+					if(time_format == TimeFormat::RELATIVE_US) {
+						utils::append_number(line, (epochs[s] - reader.start_time()) / 1000);
+					}
+					else {
+						auto time = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(epochs[s])));
+						formatter.append(line, time);
+					}
+					append_readings(line, values, schema);
+					line += '\n';
+
+					std::cout << line;
+				}
+			}
+		}
+		catch(std::runtime_error &e) {
+			// both bad_recording and bad_column
+			std::cout.flush();
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+	}
+	catch(TCLAP::ArgException &e) {
+		std::cerr << "ERROR: " << e.error() << " for arg " << e.argId() << std::endl;
+	}
+
+	return 0;
+}
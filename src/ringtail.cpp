@@ -0,0 +1,61 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <tclap/CmdLine.h>
+
+#include "RingLog.h"
+
+/**
+ * Print the lines written to a ring log by "client --ring" as they are added.
+ */
+int main(int argc, char *argv[]) {
+	try {
+		TCLAP::CmdLine cmd("Follow a PADL ring log", ' ', "0.1");
+
+		TCLAP::UnlabeledValueArg<std::string> ring_arg("ring", "The ring log to be followed", true, "", "filename");
+		TCLAP::SwitchArg from_start_arg("", "from-start", "Start from the oldest line still in the ring rather than from the next one", false);
+		TCLAP::SwitchArg no_follow_arg("n", "no-follow", "Exit once all the available lines have been printed", false);
+		TCLAP::ValueArg<int> poll_arg("", "poll", "Time to wait before looking for new lines when there are none (in microseconds), defaults to 1000", false, 1000, "microseconds");
+
+		cmd.add(ring_arg);
+		cmd.add(from_start_arg);
+		cmd.add(no_follow_arg);
+		cmd.add(poll_arg);
+
+		cmd.parse(argc, argv);
+
+		try {
+			RingLogReader reader(ring_arg.getValue(), from_start_arg.getValue());
+			auto poll_interval = std::chrono::microseconds(poll_arg.getValue());
+
+			std::string line;
+			uint64_t lost = 0;
+			while(true) {
+				if(reader.next(line)) {
+					std::cout << line << '\n';
+					continue;
+				}
+
+				if(reader.lost() != lost) {
+					std::cerr << "WARNING: " << reader.lost() - lost << " lines have been overwritten before they could be read" << std::endl;
+					lost = reader.lost();
+				}
+
+				std::cout.flush();
+				if(no_follow_arg.getValue()) {
+					break;
+				}
+				std::this_thread::sleep_for(poll_interval);
+			}
+		}
+		catch(bad_ring_log &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+	}
+	catch(TCLAP::ArgException &e) {
+		std::cerr << "ERROR: " << e.error() << " for arg " << e.argId() << std::endl;
+	}
+
+	return 0;
+}
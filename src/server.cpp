@@ -1,43 +1,72 @@
 #include <iostream>
 #include <asio.hpp>
+#include <tclap/CmdLine.h>
 
-using namespace asio;
-using ip::tcp;
-using std::string;
-using std::cout;
-using std::endl;
-
-string read_from_socket(tcp::socket &socket) {
-	asio::streambuf buf;
-	asio::read_until(socket, buf, "\n");
-	string data = asio::buffer_cast<const char*>(buf.data());
-	// remove the last character, which is an \n
-	data.pop_back();
-	return data;
-}
+#include "Hub.h"
 
-void write_to_socket(tcp::socket &socket, const string &message) {
-	asio::write(socket, asio::buffer(message + "\n"));
-}
+/**
+ * A hub that relays the lines published by one or more clients (see "client --sink tcp:HOST:PORT") to any number of
+ * local subscribers, so that several consumers can share the readings without polling the devices again.
+ */
+int main(int argc, char *argv[]) {
+	try {
+		TCLAP::CmdLine cmd("PADL hub - relay the readings published by clients to any number of subscribers", ' ', "0.1");
+
+		TCLAP::ValueArg<unsigned short> publish_port_arg("P", "publish-port", "TCP port the clients publish their lines to, defaults to 1234", false, 1234, "port");
+		TCLAP::ValueArg<unsigned short> port_arg("p", "port", "TCP port subscribers can connect to, defaults to 1235", false, 1235, "port");
+		TCLAP::ValueArg<std::string> unix_arg("u", "unix", "Also accept subscribers on a Unix socket with this path", false, "", "path");
+		TCLAP::ValueArg<std::string> bind_arg("", "bind", "Address both TCP ports are bound to, defaults to 127.0.0.1", false, "127.0.0.1", "address");
+		TCLAP::ValueArg<std::size_t> queue_arg("q", "queue", "Maximum number of bytes waiting to be sent to each subscriber, which is also the maximum length of a line, defaults to 1048576", false, 1048576, "bytes");
+		TCLAP::ValueArg<std::string> policy_arg("", "policy", "What to do when the queue of a subscriber is full: drop-oldest (discard the oldest lines that have not been sent yet) or disconnect, defaults to drop-oldest", false, "drop-oldest", "policy");
+
+		cmd.add(publish_port_arg);
+		cmd.add(port_arg);
+		cmd.add(unix_arg);
+		cmd.add(bind_arg);
+		cmd.add(queue_arg);
+		cmd.add(policy_arg);
+
+		cmd.parse(argc, argv);
 
-int main() {
-	unsigned short port_num = 1234;
-	tcp::endpoint ep(tcp::v4(), port_num);
-
-	asio::io_service io_service;
-	// listen for new connection
-	tcp::acceptor acceptor_(io_service, ep);
-	// socket creation
-	tcp::socket socket_(io_service);
-	// waiting for connection
-	acceptor_.accept(socket_);
-
-	while(true) {
-		//read operation
-		string message = read_from_socket(socket_);
-		cout << "Message from client: " << message << endl;
-		//write operation
-		write_to_socket(socket_, "Message '" + message + "' received");
+		OverflowPolicy policy;
+		asio::ip::address address;
+		try {
+			policy = Hub::parse_policy(policy_arg.getValue());
+			address = asio::ip::make_address(bind_arg.getValue());
+		}
+		catch(std::exception &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+
+		asio::io_context io_context;
+		Hub hub(io_context, queue_arg.getValue(), policy, &std::cerr);
+		try {
+			hub.listen_publishers(address, publish_port_arg.getValue());
+			hub.listen_subscribers(address, port_arg.getValue());
+			if(unix_arg.isSet()) {
+				hub.listen_subscribers(unix_arg.getValue());
+			}
+		}
+		catch(asio::system_error &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+
+		asio::signal_set signals(io_context, SIGINT, SIGTERM);
+		signals.async_wait([&hub](const asio::error_code &ec, int) {
+			if(!ec) {
+				hub.close();
+			}
+		});
+
+		// the loop returns once the hub has been closed and all the pending operations have completed
+		io_context.run();
+
+		std::cerr << "Lines relayed: " << hub.lines() << std::endl;
+	}
+	catch(TCLAP::ArgException &e) {
+		std::cerr << "ERROR: " << e.error() << " for arg " << e.argId() << std::endl;
 	}
 
 	return 0;
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <tclap/CmdLine.h>
+
+#include "SharedSamples.h"
+#include "strings.h"
+#include "TimeFormatter.h"
+
+namespace {
+
+void print_sample(std::string &line, const SharedSamplesReader &reader, std::size_t device, const SharedSample &sample, const TimeFormatter &formatter) {
+	line.clear();
+	if(reader.device_id(device) >= 0) {
+		line += reader.tag(device);
+		line += ' ';
+	}
+	utils::append_number(line, sample.delta_time);
+	line += ' ';
+	if(sample.uncertainty >= 0) {
+		utils::append_number(line, sample.uncertainty);
+		line += ' ';
+	}
+	std::chrono::system_clock::time_point time(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(sample.epoch_ns)));
+	formatter.append(line, time);
+	append_readings(line, sample.values, ChannelSchema(sample.specs.empty() ? std::vector<ChannelSpec>(1) : sample.specs));
+	std::cout << line << '\n';
+}
+
+}
+
+/**
+ * Print the samples published in shared memory by "client --shm", in the same text format as the client.
+ */
+int main(int argc, char *argv[]) {
+	try {
+		TCLAP::CmdLine cmd("Read the samples published in shared memory by a PADL client", ' ', "0.1");
+
+		TCLAP::UnlabeledValueArg<std::string> name_arg("name", "The name of the shared-memory object", true, "", "name");
+		TCLAP::SwitchArg follow_arg("f", "follow", "Print every new sample as it is published rather than the latest sample of each device", false);
+		TCLAP::ValueArg<int> poll_arg("", "poll", "Time to wait before looking for new samples when there are none (in microseconds), defaults to 1000", false, 1000, "microseconds");
+		TCLAP::ValueArg<std::string> time_format_arg("", "time-format", "Format of the current_time column: clock, iso8601, epoch-ns or relative (microseconds since shmcat was started), defaults to clock", false, "clock", "format");
+
+		cmd.add(name_arg);
+		cmd.add(follow_arg);
+		cmd.add(poll_arg);
+		cmd.add(time_format_arg);
+
+		cmd.parse(argc, argv);
+
+		TimeFormat time_format;
+		try {
+			time_format = TimeFormatter::parse_format(time_format_arg.getValue());
+		}
+		catch(std::invalid_argument &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+		TimeFormatter formatter(time_format);
+
+		try {
+			SharedSamplesReader reader(name_arg.getValue());
+			SharedSample sample;
+			std::string line;
+
+			if(!follow_arg.getValue()) {
+				for(std::size_t d = 0; d < reader.n_devices(); d++) {
+					if(reader.latest(d, sample)) {
+						print_sample(line, reader, d, sample, formatter);
+					}
+				}
+				return 0;
+			}
+
+			// start from the latest sample of each device
+			std::vector<uint64_t> next(reader.n_devices());
+			for(std::size_t d = 0; d < reader.n_devices(); d++) {
+				uint64_t count = reader.count(d);
+				next[d] = (count > 0) ? count - 1 : 0;
+			}
+
+			auto poll_interval = std::chrono::microseconds(poll_arg.getValue());
+			uint64_t lost = 0;
+			while(true) {
+				// the flag is read before the samples, so that none of the samples published before the writer went
+				// away is missed
+				bool closed = reader.closed();
+				bool found = false;
+				for(std::size_t d = 0; d < reader.n_devices(); d++) {
+					uint64_t count = reader.count(d);
+					while(next[d] < count) {
+						if(count - next[d] > reader.history()) {
+							// the writer has already overwritten these samples
+							lost += count - next[d] - reader.history();
+							next[d] = count - reader.history();
+						}
+						if(reader.get(d, next[d], sample)) {
+							print_sample(line, reader, d, sample, formatter);
+							found = true;
+						}
+						else {
+							// overwritten while it was being copied
+							lost++;
+						}
+						next[d]++;
+					}
+				}
+				if(found) {
+					continue;
+				}
+
+				if(lost > 0) {
+					std::cerr << "WARNING: " << lost << " samples have been overwritten before they could be read" << std::endl;
+					lost = 0;
+				}
+
+				std::cout.flush();
+				if(closed) {
+					break;
+				}
+				std::this_thread::sleep_for(poll_interval);
+			}
+		}
+		catch(bad_shared_samples &e) {
+			std::cerr << "ERROR: " << e.what() << std::endl;
+			return 1;
+		}
+	}
+	catch(TCLAP::ArgException &e) {
+		std::cerr << "ERROR: " << e.error() << " for arg " << e.argId() << std::endl;
+	}
+
+	return 0;
+}
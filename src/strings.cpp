@@ -9,32 +9,212 @@
 
 #include <bitset>
 #include <algorithm>
+#include <array>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UTILS_X86_SIMD
+#include <immintrin.h>
+#endif
 
 namespace utils {
 
-std::vector<std::string> split(const std::string &str, const std::string &delims) {
-	std::vector<std::string> output;
-	// this is the number of fields in an oxDNA configuration. The other common formats (LAMMPS, for instance) have even fewer, so this should be fine
-	output.reserve(15);
-
-	const char *ptr = str.c_str();
-	while(ptr) {
-		auto base = ptr;
-		ptr = std::strpbrk(ptr, delims.c_str());
-		if(ptr) {
-			// this check makes sure that no empty strings are added to the output
-			if(ptr - base) {
-				output.emplace_back(base, ptr - base);
+namespace {
+
+/**
+ * Turns delimiter and newline positions into tokens. Empty tokens are skipped, except for the last one of each line.
+ */
+struct TokenSink {
+	std::vector<Token> &tokens;
+	std::vector<uint32_t> *line_offsets;
+	uint32_t start = 0;
+
+	TokenSink(std::vector<Token> &t, std::vector<uint32_t> *lo) :
+					tokens(t),
+					line_offsets(lo) {
+
+	}
+
+	inline void delimiter(uint32_t pos) {
+		if(pos > start) {
+			tokens.push_back(Token{start, pos - start});
+		}
+		start = pos + 1;
+	}
+
+	inline void end_of_line(uint32_t pos) {
+		tokens.push_back(Token{start, pos - start});
+		start = pos + 1;
+		if(line_offsets != nullptr) {
+			line_offsets->push_back(tokens.size());
+		}
+	}
+
+	/**
+	 * Process the delimiters and newlines of a block that starts at base. Bit i of the masks is set if the character
+	 * at base + i is a delimiter (or a newline).
+	 */
+	inline void block(uint32_t base, uint32_t delim_mask, uint32_t newline_mask) {
+		uint32_t mask = delim_mask | newline_mask;
+		while(mask != 0) {
+			uint32_t bit = __builtin_ctz(mask);
+			uint32_t pos = base + bit;
+			if(newline_mask & (1u << bit)) {
+				end_of_line(pos);
 			}
-			ptr++;
+			else {
+				delimiter(pos);
+			}
+			mask &= mask - 1;
+		}
+	}
+};
+
+using DelimiterTable = std::array<bool, 256>;
+
+DelimiterTable make_table(std::string_view delims) {
+	DelimiterTable table{};
+	for(unsigned char c : delims) {
+		table[c] = true;
+	}
+	return table;
+}
+
+void scan_scalar(const char *data, uint32_t from, uint32_t size, const DelimiterTable &table, bool lines, TokenSink &sink) {
+	for(uint32_t i = from; i < size; i++) {
+		unsigned char c = data[i];
+		if(lines && c == '\n') {
+			sink.end_of_line(i);
+		}
+		else if(table[c]) {
+			sink.delimiter(i);
+		}
+	}
+}
+
+#ifdef UTILS_X86_SIMD
+
+__attribute__((target("sse2")))
+void scan_sse2(const char *data, uint32_t size, std::string_view delims, const DelimiterTable &table, bool lines, TokenSink &sink) {
+	const __m128i newline = _mm_set1_epi8('\n');
+	uint32_t i = 0;
+	for(; i + 16 <= size; i += 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i hits = _mm_setzero_si128();
+		for(char d : delims) {
+			hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(d)));
+		}
+		uint32_t newline_mask = (lines) ? _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)) : 0;
+		uint32_t delim_mask = _mm_movemask_epi8(hits) & ~newline_mask;
+		sink.block(i, delim_mask, newline_mask);
+	}
+	scan_scalar(data, i, size, table, lines, sink);
+}
+
+__attribute__((target("avx2")))
+void scan_avx2(const char *data, uint32_t size, std::string_view delims, const DelimiterTable &table, bool lines, TokenSink &sink) {
+	const __m256i newline = _mm256_set1_epi8('\n');
+	uint32_t i = 0;
+	for(; i + 32 <= size; i += 32) {
+		__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		__m256i hits = _mm256_setzero_si256();
+		for(char d : delims) {
+			hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(d)));
+		}
+		uint32_t newline_mask = (lines) ? _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)) : 0;
+		uint32_t delim_mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits)) & ~newline_mask;
+		sink.block(i, delim_mask, newline_mask);
+	}
+	scan_scalar(data, i, size, table, lines, sink);
+}
+
+#endif
+
+TokenizerISA best_isa() {
+	static TokenizerISA best = []() {
+#ifdef UTILS_X86_SIMD
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2")) {
+			return TokenizerISA::AVX2;
 		}
-		else {
-			output.emplace_back(base);
+		if(__builtin_cpu_supports("sse2")) {
+			return TokenizerISA::SSE2;
 		}
+#endif
+		return TokenizerISA::SCALAR;
+	}();
+
+	return best;
+}
+
+TokenizerISA resolve_isa(TokenizerISA isa) {
+	TokenizerISA best = best_isa();
+	// an instruction set the CPU does not support falls back to the best one it does, since the enumerators are
+	// sorted from the least to the most demanding
+	if(isa == TokenizerISA::AUTO || isa > best) {
+		return best;
+	}
+	return isa;
+}
+
+void scan(std::string_view str, std::string_view delims, bool lines, TokenSink &sink, TokenizerISA isa) {
+	DelimiterTable table = make_table(delims);
+	uint32_t size = str.size();
+
+	switch(resolve_isa(isa)) {
+#ifdef UTILS_X86_SIMD
+	case TokenizerISA::AVX2:
+		scan_avx2(str.data(), size, delims, table, lines, sink);
+		break;
+	case TokenizerISA::SSE2:
+		scan_sse2(str.data(), size, delims, table, lines, sink);
+		break;
+#endif
+	default:
+		scan_scalar(str.data(), 0, size, table, lines, sink);
+		break;
 	}
+}
+
+}
+
+const char *tokenizer_isa_name(TokenizerISA isa) {
+	switch(resolve_isa(isa)) {
+	case TokenizerISA::AVX2:
+		return "avx2";
+	case TokenizerISA::SSE2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
+
+void tokenize(std::string_view str, std::string_view delims, std::vector<Token> &tokens, TokenizerISA isa) {
+	tokens.clear();
+	TokenSink sink(tokens, nullptr);
+	scan(str, delims, false, sink, isa);
+	sink.end_of_line(str.size());
+}
 
-	if(output.size() == 0) {
-		output.push_back("");
+void tokenize_lines(std::string_view buffer, std::string_view delims, TokenizedLines &output, TokenizerISA isa) {
+	output.tokens.clear();
+	output.line_offsets.clear();
+	output.line_offsets.push_back(0);
+
+	TokenSink sink(output.tokens, &output.line_offsets);
+	scan(buffer, delims, true, sink, isa);
+	if(buffer.size() > 0 && buffer.back() != '\n') {
+		sink.end_of_line(buffer.size());
+	}
+}
+
+std::vector<std::string> split(const std::string &str, const std::string &delims) {
+	std::vector<Token> tokens;
+	tokenize(str, delims, tokens);
+
+	std::vector<std::string> output;
+	output.reserve(tokens.size());
+	for(auto &token : tokens) {
+		output.emplace_back(str, token.begin, token.length);
 	}
 
 	return output;
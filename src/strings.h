@@ -8,12 +8,80 @@
 #ifndef UTILS_STRINGS_H_
 #define UTILS_STRINGS_H_
 
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <vector>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <fast_double_parser/fast_double_parser.h>
 
 namespace utils {
 
+/**
+ * A token, given as an offset into the string it has been extracted from and a length.
+ */
+struct Token {
+	uint32_t begin;
+	uint32_t length;
+
+	std::string_view in(std::string_view source) const {
+		return source.substr(begin, length);
+	}
+};
+
+/**
+ * The tokens of a batch of lines. The tokens of the i-th line are tokens[line_offsets[i]] ... tokens[line_offsets[i + 1] - 1].
+ */
+struct TokenizedLines {
+	std::vector<Token> tokens;
+	std::vector<uint32_t> line_offsets;
+
+	std::size_t n_lines() const {
+		return line_offsets.size() - 1;
+	}
+};
+
+/**
+ * The instruction sets the tokenizer can use, from the least to the most demanding. AUTO picks the best one supported
+ * by the CPU at runtime. An instruction set the CPU does not support is replaced by the best one it does.
+ */
+enum class TokenizerISA {
+	AUTO, SCALAR, SSE2, AVX2
+};
+
+/**
+ * Return the name of the instruction set that the tokenizer actually uses when the given one is requested.
+ */
+const char *tokenizer_isa_name(TokenizerISA isa=TokenizerISA::AUTO);
+
+/**
+ * Split a string into tokens, with the same rules as split(), without copying it. Delimiter positions are found
+ * in blocks of 16 or 32 bytes with SIMD instructions, if available.
+ *
+ * @param str
+ * @param delims list of separators that will be used to split the string
+ * @param tokens the vector the tokens will be stored in. Its previous content is discarded
+ * @param isa
+ */
+void tokenize(std::string_view str, std::string_view delims, std::vector<Token> &tokens, TokenizerISA isa=TokenizerISA::AUTO);
+
+/**
+ * Tokenize a buffer containing many newline-separated lines in a single pass. Each line is split with the same rules
+ * as split(). If the buffer does not end with a newline, the trailing characters make up the last line.
+ * Token offsets are relative to the beginning of the buffer.
+ *
+ * @param buffer
+ * @param delims list of separators that will be used to split the lines
+ * @param output
+ * @param isa
+ */
+void tokenize_lines(std::string_view buffer, std::string_view delims, TokenizedLines &output, TokenizerISA isa=TokenizerISA::AUTO);
+
 /**
  * Split a string into tokens.
  *
@@ -50,53 +118,132 @@ class bad_lexical_cast: public std::exception {
 };
 
 /**
- * Cast the given string to a numeric type. Trim the string before attempting to cast it.
+ * The outcome of a try_parse call.
+ */
+enum class ParseStatus {
+	OK, EMPTY, INVALID, OUT_OF_RANGE
+};
+
+/**
+ * Return a view on the given string, without trailing and leading spaces
+ */
+inline std::string_view trim_view(std::string_view source) {
+	const char *spaces = " \t\n\v\f\r";
+	auto begin = source.find_first_not_of(spaces);
+	if(begin == std::string_view::npos) {
+		return std::string_view();
+	}
+	auto end = source.find_last_not_of(spaces);
+	return source.substr(begin, end - begin + 1);
+}
+
+/**
+ * Convert the given string to an integral or floating-point type without throwing and independently of the current
+ * locale. Leading and trailing spaces and a leading + are ignored, but the rest of the string must be a valid number.
+ * Integers are converted with std::from_chars, floating-point numbers with fast_double_parser.
  *
  * @param source
- * @return
+ * @param value set to the converted value if the conversion is successful, left untouched otherwise
+ * @return the outcome of the conversion
  */
 template<typename T>
-T lexical_cast(std::string source) {
-	T var;
-	std::istringstream iss;
-	iss.str(trim_copy(source));
-	iss >> var;
+ParseStatus try_parse(std::string_view source, T &value) {
+	static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "try_parse supports only integral and floating-point types");
 
-	if(iss.fail() || iss.bad()) {
-		throw bad_lexical_cast();
+	source = trim_view(source);
+	if(source.empty()) {
+		return ParseStatus::EMPTY;
 	}
 
-	return var;
-}
-
-template<>
-inline double lexical_cast(std::string source) {
-	double result;
-
-	const char *endptr = fast_double_parser::parse_number(source.c_str(), &result);
+	const char *begin = source.data();
+	const char *end = begin + source.size();
+	if(*begin == '+') {
+		begin++;
+		if(begin == end || *begin == '-' || *begin == '+') {
+			return ParseStatus::INVALID;
+		}
+	}
 
-	if(endptr == nullptr) {
-		throw bad_lexical_cast();
+	if constexpr (std::is_integral<T>::value) {
+		auto res = std::from_chars(begin, end, value);
+		if(res.ec == std::errc::result_out_of_range) {
+			return ParseStatus::OUT_OF_RANGE;
+		}
+		if(res.ec != std::errc() || res.ptr != end) {
+			return ParseStatus::INVALID;
+		}
+		return ParseStatus::OK;
 	}
+	else {
+		double result;
+		// fast_double_parser needs a null-terminated string
+		char buffer[64];
+		std::size_t length = end - begin;
+		if(length >= sizeof(buffer)) {
+			return ParseStatus::INVALID;
+		}
+		std::memcpy(buffer, begin, length);
+		buffer[length] = '\0';
+
+		const char *endptr = fast_double_parser::parse_number(buffer, &result);
+		if(endptr == nullptr) {
+			// the slow path tells apart numbers that are out of range from invalid ones
+			auto res = std::from_chars(buffer, buffer + length, result);
+			if(res.ec == std::errc::result_out_of_range) {
+				return ParseStatus::OUT_OF_RANGE;
+			}
+			endptr = (res.ec == std::errc()) ? res.ptr : nullptr;
+		}
+		if(endptr != buffer + length) {
+			return ParseStatus::INVALID;
+		}
+		if(std::isinf(result) || std::abs(result) > std::numeric_limits<T>::max()) {
+			return ParseStatus::OUT_OF_RANGE;
+		}
+
+		value = static_cast<T>(result);
+		return ParseStatus::OK;
+	}
+}
 
-	return result;
+/**
+ * Append the decimal representation of an integer to the given string without going through a stream.
+ */
+template<typename T>
+void append_number(std::string &out, T value) {
+	static_assert(std::is_integral<T>::value, "append_number supports only integral types");
+	char buffer[24];
+	auto res = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	out.append(buffer, res.ptr - buffer);
 }
 
-template<>
-inline int lexical_cast(std::string source) {
-	int result;
+/**
+ * Cast the given string to a numeric type. Trim the string before attempting to cast it. Arithmetic types are
+ * converted with try_parse, all the others with a std::istringstream.
+ *
+ * @param source
+ * @return
+ */
+template<typename T>
+T lexical_cast(std::string_view source) {
+	T var;
 
-	try {
-		result = std::stoi(source);
-	}
-	catch (std::invalid_argument &) {
-		throw bad_lexical_cast();
+	if constexpr (std::is_arithmetic<T>::value && !std::is_same<T, bool>::value) {
+		if(try_parse(source, var) != ParseStatus::OK) {
+			throw bad_lexical_cast();
+		}
 	}
-	catch (std::out_of_range &) {
-		throw bad_lexical_cast();
+	else {
+		std::istringstream iss;
+		iss.str(std::string(trim_view(source)));
+		iss >> var;
+
+		if(iss.fail() || iss.bad()) {
+			throw bad_lexical_cast();
+		}
 	}
 
-	return result;
+	return var;
 }
 
 }